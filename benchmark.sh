@@ -1,18 +1,29 @@
-# usage : ./benchmark.sh data_dir sol_dir model
+# usage : ./benchmark.sh data_dir sol_dir model [repeats]
+# extra model options (e.g. --config=<file>) can be given in the ARGS variable
+# MEMORY_BUDGET (in MB) makes the models downsize or refuse the runs predicted to exceed it
+
+repeats=${4:-1} # number of runs per instance, compare.out uses the median runtime
+if [ -n "$MEMORY_BUDGET" ] ; then
+    ARGS="$ARGS --memory-budget=$MEMORY_BUDGET"
+fi
 
 echo Experimental Campaign: Traveling Salesman Problem
 echo Data directory: $1
 echo Output directory: $2
 echo Model: $3
+echo Repeats: $repeats
 
 mkdir -p $2 # create the output directory if it does not already exist
 echo `date` > $2/date.txt
 
 cd build
 for instance in `ls $1` ; do  # for each instance in directory $1
-    echo Resolution of $instance
-    ./$3.out $1/$instance -nv >> ../$2/log_${instance}.txt   # writing console output to a log file
+    for run in `seq $repeats` ; do
+        echo Resolution of $instance \(run $run\)
+        ./$3.out $1/$instance -nv $ARGS >> ../$2/log_${instance}.txt   # writing console output to a log file
+    done
 done
 
 cd ..
-grep Result $2/*.txt >> $2/results.csv  # lines containing the word "Result" will be concatenated in the results.csv file
\ No newline at end of file
+grep Result $2/*.txt >> $2/results.csv  # lines containing the word "Result" will be concatenated in the results.csv file
+grep -h Refused $2/*.txt  # runs refused for the memory budget
@@ -0,0 +1,24 @@
+#ifndef ASSIGNMENT_HPP
+#define ASSIGNMENT_HPP
+
+#include <vector>
+
+// solution of the assignment problem (the relaxation of the ATSP without
+// subtour elimination) with its dual potentials
+struct Assignment
+{
+    std::vector<int> succ;      ///< city assigned after each city
+    std::vector<long long> u;   ///< dual of "one arc leaves i"
+    std::vector<long long> v;   ///< dual of "one arc enters j"
+    long long cost;             ///< a lower bound on any tour
+
+    // reduced cost of the arc (i,j), never negative
+    long long reducedCost(const std::vector<std::vector<int>> &c, int i, int j) const
+    {
+        return c[i][j] - u[i] - v[j];
+    }
+};
+
+Assignment solveAssignment(const std::vector<std::vector<int>> &c);
+
+#endif
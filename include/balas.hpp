@@ -0,0 +1,40 @@
+#ifndef BALAS_HPP
+#define BALAS_HPP
+
+#include <random>
+#include <vector>
+
+// Balas-Simonetti neighbourhood of a tour: every reordering of its cities
+// (the first one staying first) in which the city at position i comes before
+// the one at position j whenever j >= i + k, so that no city moves by k
+// positions or more. It has an exponential number of tours and its best one is
+// found by a dynamic program linear in n, in O(k^2 2^k n) time.
+//
+// A state of the program is the set of the cities placed so far and the last
+// of them. All the positions before the first unplaced one m are placed, and
+// none from m + k on: the state is m, the placed positions among m+1..m+k-1
+// (a mask of k-1 bits) and the offset d of the last one from m, in -k..k-1.
+// The next city is at m + e, e in 0..k-1 not in the mask; which state it leads
+// to depends on the mask and e only, given by a table built once per k.
+
+struct BalasSimonettiTable
+{
+    int k;                    ///< from 2 to 16
+    int masks;                ///< 2^(k-1)
+    std::vector<int> next;    ///< next[mask * k + e]: mask after placing m + e, -1 if m + e is placed
+    std::vector<int> shift;   ///< shift[mask * k + e]: increase of m (0 unless e = 0)
+
+    BalasSimonettiTable(int _k);
+};
+
+// best tour of the neighbourhood of succ, starting from the city start;
+// returns true and replaces succ if it is cheaper. The predecessors of the
+// states take n 2^(k-1) 2k bytes (1 MB for n = 500 and k = 8).
+bool balasSimonetti(const std::vector<std::vector<int>> &c, std::vector<int> &succ, const BalasSimonettiTable &table, int start = 0);
+// passes from random starting cities, each improving one followed by Or-opt
+// (see heuristic.hpp), until `failures` passes in a row do not improve the
+// tour; returns the number of improving passes
+int balasSimonettiSearch(const std::vector<std::vector<int>> &c, std::vector<int> &succ, const BalasSimonettiTable &table, std::mt19937 &rng,
+                         int failures = 3);
+
+#endif
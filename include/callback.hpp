@@ -0,0 +1,113 @@
+#ifndef CALLBACK_HPP
+#define CALLBACK_HPP
+
+#include "gurobi_c++.h"
+#include "checkpoint.hpp"
+#include "config.hpp"
+#include "cutstats.hpp"
+#include "graph.hpp"
+#include "incumbent.hpp"
+#include "relabel.hpp"
+#include "trace.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+// the arcs of a graph in terms of the variables of a model: the use of the arc
+// arcOf[v] in a solution is the sum of the values of vars[v] (one variable per
+// arc, or one per arc and position for the flow models)
+struct ArcVariables
+{
+    const Graph *g;
+    std::vector<GRBVar> vars;
+    std::vector<int> arcOf;
+    bool symmetric; ///< the arcs of g are edges
+
+    ArcVariables(const Graph *_g, bool _symmetric = false);
+    // one variable per arc
+    ArcVariables(const Graph *_g, const GRBVar *x, bool _symmetric = false);
+    void add(GRBVar var, int arc);
+};
+
+// base of the callbacks of every model: samples the progress of the solver at
+// the MIP and MIPSOL events into a trace (see trace.hpp), then calls the
+// separation of the model, counting the events, the time spent separating and
+// the cuts added (see cutstats.hpp). Models without separation use it as is.
+//
+// With watch(), it also streams every improving tour found at MIPSOL (option
+// "incumbents=<file>", "-" for stdout, see incumbent.hpp) and stops the solve
+// as soon as the file of the option "stop-file" exists, so that a consumer of
+// the stream can end the run once a tour is good enough. With the option
+// "checkpoint=<file>", the best tour, the bound and the cuts are saved every
+// "checkpoint-every" (60) seconds of solver time and at the end (see checkpoint.hpp).
+// With the option "relabel-map=<file>" (the .map of relabel.out, see
+// relabel.hpp), the streamed tours and the cities of the verbose output are
+// those of the original instance; the checkpoints stay in the labels of the model.
+// With the option "patching", the relaxation of the MIPNODE events is turned
+// into a tour by Karp patching (see patchRelaxation in heuristic.hpp), given to
+// the solver when it beats the incumbent; it takes at most "patching-budget"
+// (0.05) of the solver time. The flow models get the arc variables of the tour
+// left undefined, for the solver to complete.
+class ModelCallback : public GRBCallback
+{
+public:
+    Trace trace;
+    CutStats stats;
+
+    ModelCallback();
+    // instance: instanceHash of the costs (see cutlib.hpp), written in the checkpoints
+    void watch(const Config &config, const ArcVariables &arcs, unsigned long long instance);
+    // state of the previous runs, which the checkpoints of this one extend
+    void resume(const Checkpoint &previous);
+    // the writer of the stream, if any, once it has written everything queued
+    void closeStream();
+    long streamed() const;
+    // writes the checkpoint, if any, with the given bound and solver time of this run
+    void saveCheckpoint(double bound, double runtime);
+    // solver time of this run and the runs it resumes
+    double totalRuntime(double runtime) const;
+    // city of the original instance that the city v of the model stands for
+    int city(int v) const { return relabelling.original.empty() ? v : relabelling.original[v]; }
+
+protected:
+    void callback();
+    // separation of the model, called at every event
+    virtual void separate() {}
+
+    // add the constraint and record it in the statistics, with its violation at
+    // the separated point and a support identifying it (e.g. the cities of a subtour)
+    using GRBCallback::addCut;
+    using GRBCallback::addLazy;
+    void addCut(const GRBTempConstr &constr, double violation, const std::vector<int> &support);
+    void addLazy(const GRBTempConstr &constr, double violation, const std::vector<int> &support);
+    // adds the cuts found by the separation to a checkpoint
+    virtual void saveCuts(Checkpoint &) const {}
+
+private:
+    std::unique_ptr<IncumbentStream> stream;
+    std::unique_ptr<ArcVariables> arcs;
+    std::vector<int> bestTour; ///< best tour seen at MIPSOL, when streamed or checkpointed
+    double bestObjective;
+    long streamedCount;
+    std::string stopFile;
+    double lastStopCheck; ///< runtime of the last look for the stop file
+    Checkpoint previous;
+    std::string checkpointFile;
+    double checkpointEvery;
+    double lastCheckpoint; ///< runtime of the last checkpoint
+    std::vector<std::vector<int>> patchCosts; ///< costs of the arcs of the graph, forbidden elsewhere; empty without patching
+    double patchBudget;
+    std::vector<int> lastPatched; ///< last tour of the patching heuristic
+    Relabelling relabelling;      ///< empty without a relabel map
+
+    void recordIncumbent();
+    void patchNode();
+    void checkStop();
+};
+
+// closes the trace with the final state of the model, writes it to the file of
+// the "trace" option of the configuration, if any, closes the incumbent stream,
+// writes the last checkpoint and prints the statistics of the callback in verbose mode
+void finishCallback(GRBModel &model, ModelCallback &cb, const Config &config);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <string>
+#include <vector>
+
+// What a solve leaves to a later run of the same instance (--checkpoint,
+// --resume, and the states of the re-optimisation, see reopt.hpp): the best
+// tour, the best bound, the solver time spent and the cuts found. The search
+// tree and the pseudo-costs of Gurobi are not exposed by its API: a resumed
+// run rebuilds its tree, but from the cuts, the bound and the tour as MIP start.
+struct Checkpoint
+{
+    int n;
+    unsigned long long instance; ///< instanceHash of the costs (see cutlib.hpp), 0 if unknown
+    std::vector<int> succ; ///< best tour, empty if none
+    double objective;      ///< cost of the tour
+    double bound;          ///< best bound, -infinity if none
+    double runtime;        ///< solver time of all the runs so far, in seconds
+    std::vector<std::vector<int>> subtours; ///< sets S of the subtour constraints x(S) <= |S| - 1
+    std::vector<std::vector<int>> links;    ///< (i, j, k) of the flow linking cuts x(i,j,k) <= sum_l x(j,l,k+1)
+
+    Checkpoint();
+};
+
+// text file of "n", "instance", "tour", "objective", "bound" and "runtime"
+// lines, then one "cut <size> <cities>" or "link <i> <j> <k>" line per cut.
+// Returns false if the file cannot be opened, exits if it belongs to another
+// instance than c (its size or its hash differ, or it has no hash).
+bool readCheckpoint(std::string filePath, const std::vector<std::vector<int>> &c, Checkpoint &checkpoint);
+// writes a temporary file renamed over the previous checkpoint, which stays
+// whole if the run is killed while writing
+bool writeCheckpoint(std::string filePath, const Checkpoint &checkpoint);
+
+#endif
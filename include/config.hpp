@@ -0,0 +1,45 @@
+#ifndef CONFIG_HPP
+#define CONFIG_HPP
+
+#include <map>
+#include <string>
+
+// Run configuration of a model, read from the command line and optionally a file:
+//
+//   ./<model>.out <PATH_TO_DAT_FILE> [-nv] [--config=<file>] [--<key>=<value>]...
+//
+// The file holds one "key = value" per line (# starts a comment) with the same
+// keys as the command line, which takes precedence over it. Known keys:
+//   time-limit      time limit of the solver in seconds (default: the model's own)
+//   threads         solver threads (default: all the available cores)
+//   param.<Name>    any Gurobi parameter, e.g. --param.MIPFocus=1
+//   tune            run the Gurobi tuning tool once per formulation and size class
+//   tune-cache      directory of the tuned parameter files (default: tune_cache)
+//   tune-time       time limit of a tuning run in seconds (default: 120)
+//   incumbents      file receiving each improving tour as a JSON line, "-" for stdout (see incumbent.hpp)
+//   relabel-map     .map file of relabel.out: tours streamed and printed in the cities of the original instance
+//   stop-file       the solve stops, keeping its best tour, as soon as this file exists
+//   checkpoint      file receiving the best tour, bound and cuts of the solve (see checkpoint.hpp)
+//   checkpoint-every  seconds of solver time between two checkpoints (default: 60)
+//   resume          start from the checkpoint file, if it exists (sousTours and flot_callback)
+//   patching        Karp patching heuristic on the node relaxations (see callback.hpp)
+//   patching-budget share of the solver time it may take (default: 0.05)
+//   memory-budget   in MB: fewer threads, or no run at all, for a model predicted to exceed it (see memory.hpp)
+// Any other key is an option of the model itself (see each model).
+struct Config
+{
+    std::string instance;
+    bool verbose;
+    double timeLimit;
+    int threads;
+    std::map<std::string, std::string> params;  ///< Gurobi parameters set as given
+    std::map<std::string, std::string> options; ///< every other key
+
+    bool has(std::string key) const;
+    std::string get(std::string key, std::string otherwise = "") const;
+    double number(std::string key, double otherwise) const;
+};
+
+Config parseArgs(int argc, char *argv[], double defaultTimeLimit);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef CUTLIB_HPP
+#define CUTLIB_HPP
+
+#include <string>
+#include <vector>
+
+// Subtour constraints x(S) <= |S| - 1 found by the runs of an instance, kept on
+// disk between runs (option "cut-library=<dir>"): sousTours and sousTours_cut
+// add the strongest ones to their model before the solve, as regular
+// constraints, instead of finding them again. A set S is valid for the
+// directed and the undirected models alike, so the library of an instance is
+// shared by every formulation.
+//
+// Each run halves the score of every cut, then adds 1 to the cuts it found and
+// to the seeded cuts tight at its final tour: the score counts how often a cut
+// is binding, the recent runs weighing most. Beyond the capacity of the
+// library, the cuts of lowest score are evicted.
+
+struct LibraryCut
+{
+    std::vector<int> S; ///< sorted cities
+    double score;
+    int lastRun; ///< last run that found it or where it was tight
+};
+
+struct CutLibrary
+{
+    std::string path; ///< file of the instance in the library directory
+    int n;
+    int runs; ///< runs recorded so far
+    std::vector<LibraryCut> cuts;
+};
+
+// FNV-1a hash of the size and the costs of the instance, which names its file
+unsigned long long instanceHash(const std::vector<std::vector<int>> &c);
+
+// the library of the instance in the directory; empty if it has none yet
+CutLibrary loadCutLibrary(std::string directory, const std::vector<std::vector<int>> &c);
+// writes it ("n", "runs" then one "cut <score> <last run> <size> <cities>" line
+// per cut) through a temporary file; false on failure
+bool saveCutLibrary(const CutLibrary &library);
+
+// the count cuts of highest score, the smallest sets first among equal scores
+std::vector<std::vector<int>> seedCuts(const CutLibrary &library, int count);
+// records a run: the cuts it found, the cuts it was seeded with and its final
+// tour (empty if none); keeps at most capacity cuts
+void recordRun(CutLibrary &library, const std::vector<std::vector<int>> &found, const std::vector<std::vector<int>> &seeds,
+               const std::vector<int> &succ, size_t capacity);
+
+#endif
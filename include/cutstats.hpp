@@ -0,0 +1,48 @@
+#ifndef CUTSTATS_HPP
+#define CUTSTATS_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// counters of the cut loop of a callback (see callback.hpp), cheap enough to
+// stay enabled: a few increments per event and one hash per cut
+
+// bounds of the violation histogram: a cut falls in the first bin whose bound
+// is not below its violation, the last bin takes everything above 1
+const int violationBins = 6;
+const double violationBounds[violationBins - 1] = {0.0, 0.01, 0.1, 0.5, 1.0};
+
+struct CutStats
+{
+    static const int whereCount = 16; ///< GRB_CB_* values are small integers
+    long calls[whereCount];           ///< callback invocations per where
+    double separationTime;            ///< seconds spent in the separation of the model
+    long cuts;                        ///< user cuts added at MIPNODE
+    long lazies;                      ///< lazy constraints added at MIPSOL (or MIPNODE)
+    long duplicates;                  ///< cuts or lazies with the same support as an earlier one
+    long histogram[violationBins];    ///< violation of the added cuts at the separated point
+    long patched;                     ///< distinct tours of the patching heuristic (see callback.hpp)
+    long injected;                    ///< those better than the incumbent, given to the solver
+    double patchTime;                 ///< seconds spent in the patching heuristic
+
+    CutStats();
+    void call(int where);
+    // records a cut; support identifies it (e.g. the cities of a subtour),
+    // the same support twice counts as a duplicate
+    void add(bool lazy, double violation, const std::vector<int> &support);
+    long totalCalls() const;
+
+    // multi-line summary, for the verbose output
+    void print(std::ostream &out) const;
+    // "key = value; ..." fields for the Result line, those of the patching
+    // heuristic when it has run
+    std::string resultFields() const;
+
+private:
+    std::unordered_set<uint64_t> seen;
+};
+
+#endif
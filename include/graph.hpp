@@ -0,0 +1,46 @@
+#ifndef GRAPH_HPP
+#define GRAPH_HPP
+
+#include <utility>
+#include <vector>
+
+// Sparse set of the arcs a formulation may use, stored both ways:
+// arcs leaving i are the ids outStart[i] .. outStart[i+1]-1 (sorted by head),
+// arcs entering j are inArc[inStart[j]] .. inArc[inStart[j+1]-1] (sorted by tail).
+// Models create one variable per arc id instead of one per pair of cities.
+struct Graph
+{
+    int n; ///< number of cities
+    int m; ///< number of arcs kept
+    std::vector<int> tail, head, cost;
+    std::vector<int> outStart;
+    std::vector<int> inStart, inArc;
+    int forbidden; ///< arcs removed because of their forbidden cost (diagonal included)
+    int dominated; ///< arcs removed because no tour better than the upper bound can use them
+    long long lowerBound, upperBound;
+
+    // id of the arc (i,j), -1 if it is not in the graph
+    int arc(int i, int j) const;
+};
+
+// keeps the arcs of finite cost; with reduce, also removes the arcs whose
+// reduced cost in the assignment relaxation exceeds the gap between the
+// assignment bound and a heuristic tour (they cannot be in an optimal tour).
+// The gap is widened by slack and the arcs of extra are always kept, even
+// forbidden ones, for the cost changes of a later re-optimisation (see reopt.hpp).
+Graph buildGraph(const std::vector<std::vector<int>> &c, bool reduce = true, long long slack = 0,
+                 const std::vector<std::pair<int, int>> &extra = std::vector<std::pair<int, int>>());
+// graph made of the given arcs only (duplicates are ignored)
+Graph restrictGraph(const std::vector<std::vector<int>> &c, const std::vector<std::pair<int, int>> &arcs);
+void printReport(const Graph &g);
+// successors along the cycle through city 0 of the arcs (edges, oriented from
+// city 0, when symmetric) of value at least 0.5; -1 for the cities off it
+std::vector<int> arcSuccessors(const Graph &g, const std::vector<double> &value, bool symmetric);
+// sets S of the short subtour constraints worth adding before the solve: the
+// pairs {i,j} of the 2-cycles of g (directed graphs only), then at most
+// triangles sets {i,j,k} of the 3-cycles of g of smallest reduced cost in the
+// assignment relaxation, each city being tried with its neighbours (cheapest
+// reduced costs first) of g
+std::vector<std::vector<int>> shortCycles(const std::vector<std::vector<int>> &c, const Graph &g, bool symmetric, int triangles, int neighbours);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef HEURISTIC_HPP
+#define HEURISTIC_HPP
+
+#include <random>
+#include <vector>
+
+// constructions and local search for the ATSP, working on successor arrays
+// (see tour.hpp); they give upper bounds and starting tours to the models
+
+std::vector<int> nearestNeighbour(const std::vector<std::vector<int>> &c, int start = 0);
+// merges the cycles of a cycle cover into a single tour (Karp patching): the
+// two cycles exchange the successors of the pair of cities that costs the least
+void patchCycles(const std::vector<std::vector<int>> &c, std::vector<int> &succ);
+// tour near a fractional solution x (n x n, row-major): rounds it to the
+// assignment of the costs c(i,j) (1 - x(i,j)), patches its cycles and improves
+// the tour with Or-opt; empty if the tour needs an arc of forbidden cost
+// (the primal heuristic of the callbacks, see callback.hpp)
+std::vector<int> patchRelaxation(const std::vector<std::vector<int>> &c, const std::vector<double> &x);
+// moves segments of 1 to maxSegment cities elsewhere in the tour (without
+// reversing them) while it improves; returns true if the tour was improved
+bool orOpt(const std::vector<std::vector<int>> &c, std::vector<int> &succ, int maxSegment = 3);
+// the same with a scratch array for the predecessors, for repeated calls
+bool orOpt(const std::vector<std::vector<int>> &c, std::vector<int> &succ, int maxSegment, std::vector<int> &pred);
+
+// randomised constructions and kicks of the multi-start heuristic (multistart.hpp),
+// writing into scratch arrays resized as needed
+
+// nearest neighbour from a random city, choosing at each step among the
+// `candidates` cheapest unvisited cities: the cheapest with probability 1/2,
+// the next one with 1/4, and so on
+void randomNearestNeighbour(const std::vector<std::vector<int>> &c, std::mt19937_64 &rng, int candidates, std::vector<int> &succ, std::vector<char> &visited);
+// double bridge: the tour A B C D becomes A C B D, which keeps the direction of
+// every segment (no arc is reversed on asymmetric instances)
+void doubleBridge(std::vector<int> &succ, std::mt19937_64 &rng, std::vector<int> &tour);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef INCUMBENT_HPP
+#define INCUMBENT_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// improving tours streamed while a model runs (option "incumbents", see
+// callback.hpp), one JSON line each, flushed at once:
+//   {"time":1.52,"objective":2755,"bound":2701.5,"succ":[12,0,...]}
+// The callback only queues the tour; a writer thread formats and writes it, so
+// that a slow consumer never stalls the solver.
+
+struct Incumbent
+{
+    double time; ///< seconds since the start of the solve
+    double objective;
+    double bound;
+    std::vector<int> succ;
+};
+
+class IncumbentStream
+{
+public:
+    // "-" writes to stdout
+    IncumbentStream(std::string filePath, size_t capacity = 64);
+    // writes the incumbents still queued, then stops the writer
+    ~IncumbentStream();
+
+    bool ok() const;
+    // never waits for the writer: when it is capacity incumbents behind, the
+    // oldest one is dropped, a better one being queued after it
+    void push(Incumbent incumbent);
+    long written() const;
+    long dropped() const;
+
+private:
+    std::ofstream file;
+    std::ostream *out;
+    size_t capacity;
+    std::mutex lock;
+    std::condition_variable ready;
+    std::deque<Incumbent> queue;
+    bool stopping;
+    std::atomic<long> writes;
+    std::atomic<long> drops;
+    std::thread writer;
+
+    void run();
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef JSON_HPP
+#define JSON_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+
+// minimal JSON reader and writer helpers for the JSON lines protocol of the
+// solver service (service.cpp): numbers are doubles, objects are sorted maps
+
+struct JsonValue
+{
+    enum Type
+    {
+        NUL,
+        BOOLEAN,
+        NUMBER,
+        STRING,
+        ARRAY,
+        OBJECT
+    };
+    Type type;
+    bool boolean;
+    double number;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::map<std::string, JsonValue> members;
+
+    JsonValue();
+    bool has(std::string key) const;
+    // member of an object, a null value if there is none
+    const JsonValue &operator[](std::string key) const;
+};
+
+// parses a whole document; on failure returns false and describes the error
+bool parseJson(const std::string &text, JsonValue &value, std::string &error);
+// the string quoted and escaped
+std::string jsonString(const std::string &s);
+
+#endif
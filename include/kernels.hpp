@@ -0,0 +1,52 @@
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include <string>
+#include <vector>
+
+// Batched kernels over the cost matrix for the local searches: the cost of a
+// tour, the deltas of inserting a segment at every position of a tour, and the
+// cheapest successor or predecessor of a batch of cities. They are gathers in
+// an n x n matrix: each has a scalar version and AVX2 and AVX-512 versions
+// (x86 with GCC or Clang only), the best one supported by the processor being
+// chosen at run time. Every version gives the same results.
+
+// the cost matrix in one block, row-major with rows of stride integers (n
+// rounded up to a multiple of 16); the indices of the gathers are 32-bit, which
+// bounds n to about 46000
+struct CostMatrix
+{
+    int n;
+    int stride;
+    std::vector<int> data;
+
+    CostMatrix(const std::vector<std::vector<int>> &c);
+    const int *row(int i) const { return data.data() + (size_t)i * stride; }
+};
+
+enum KernelLevel
+{
+    ScalarKernels,
+    Avx2Kernels,
+    Avx512Kernels
+};
+
+// the best level supported by the processor, used by default
+KernelLevel supportedKernels();
+// the level of the next calls, lowered to the supported one; returns it
+KernelLevel setKernels(KernelLevel level);
+KernelLevel currentKernels();
+std::string kernelName(KernelLevel level);
+
+// cost of the tour (ordered list of its n cities, see tour.hpp)
+long long tourCostBatch(const CostMatrix &c, const std::vector<int> &tour);
+// delta[k] = c(a, first) + c(last, b) - c(a, b) for the arc (a, b) = (tour[k],
+// tour[k + 1]) of the tour, wrapping around: the cost of inserting the segment
+// first..last between a and b (the segment being already out of the tour)
+void insertionDeltas(const CostMatrix &c, const std::vector<int> &tour, int first, int last, std::vector<int> &delta);
+// best[k] is the cheapest successor (predecessor) j != cities[k] of cities[k],
+// the smallest such j on ties
+void bestSuccessors(const CostMatrix &c, const std::vector<int> &cities, std::vector<int> &best);
+void bestPredecessors(const CostMatrix &c, const std::vector<int> &cities, std::vector<int> &best);
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef LNS_HPP
+#define LNS_HPP
+
+#include "trace.hpp"
+#include <random>
+#include <vector>
+
+// Large neighbourhood search for the instances out of reach of the exact models
+// (sousTours.cpp --lns). Each round destroys a few disjoint windows of the current
+// tour and repairs them in parallel with the subtour model (see subtour.hpp): in
+// the repair of a window, every arc of the tour that does not touch the window
+// is fixed, so that the paths between its cities become single cities of a much
+// smaller instance.
+
+struct LnsOptions
+{
+    double timeLimit;   ///< of the whole search, in seconds
+    int threads;        ///< repairs run in parallel, one thread and Gurobi environment each
+    double repairLimit; ///< time limit of each repair MIP, in seconds
+    int window;         ///< initial number of cities of a window, adapted during the search
+    unsigned seed;
+    int polish;         ///< k of the Balas-Simonetti search (see balas.hpp) on each improved tour, 0 for none
+    bool verbose;
+};
+
+struct LnsStats
+{
+    long rounds;
+    long repairs;
+    long improvements; ///< repairs that gave a better tour and were applied
+    long timeouts;     ///< repairs stopped by their time limit
+    int window;        ///< final window size
+};
+
+// destroy operators, used in turn; the windows of a round never share a city nor
+// a tour arc, so that their repairs can be applied together
+enum WindowKind
+{
+    SEGMENT_WINDOW, ///< consecutive cities of the tour
+    RANDOM_WINDOW,  ///< cities drawn uniformly
+    COST_WINDOW     ///< cities whose outgoing arc costs the most above their cheapest one
+};
+std::vector<std::vector<int>> destroyWindows(const std::vector<std::vector<int>> &c, const std::vector<int> &succ, WindowKind kind, int count, int size, std::mt19937 &rng);
+
+// instance of the repair of a window: its cities and the fixed paths between them
+// become the nodes p of a smaller instance, entered at first[p] and left at last[p]
+struct Contraction
+{
+    std::vector<int> first, last;
+    std::vector<std::vector<int>> c;
+    std::vector<int> succ; ///< the current tour in the smaller instance
+};
+Contraction contract(const std::vector<std::vector<int>> &c, const std::vector<int> &succ, const std::vector<int> &window);
+// tour of the original instance given by a tour of the smaller one
+std::vector<int> expand(const Contraction &contraction, const std::vector<int> &succ, const std::vector<int> &contractedSucc);
+
+// starting tour: patched assignment (with the assignment bound as lower bound)
+// up to 1000 cities, nearest neighbour beyond (lowerBound = -1), then Or-opt
+// and, with polish = k, the Balas-Simonetti search (see balas.hpp)
+std::vector<int> startingTour(const std::vector<std::vector<int>> &c, long long &lowerBound, int polish = 0);
+// improves succ until the time limit; the trace records the cost of the tour
+// (and the lower bound, if any) after each round: the improvement curve
+std::vector<int> lns(const std::vector<std::vector<int>> &c, std::vector<int> succ, long long lowerBound, const LnsOptions &options, Trace &trace, LnsStats &stats);
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef MEMETIC_HPP
+#define MEMETIC_HPP
+
+#include <random>
+#include <vector>
+
+// Memetic algorithm for the ATSP: the edge assembly crossover (EAX) of Nagata,
+// adapted to directed tours, with Or-opt as mutation and the entropy preserving
+// replacement of Nagata and Kobayashi. Each generation pairs every individual A
+// with the next one B of a random order, builds children of A from the AB-cycles
+// of the pair in parallel (see pool.hpp) and replaces A by its best child.
+
+struct MemeticOptions
+{
+    int threads;
+    int population;
+    int children;     ///< AB-cycles tried for each pair of parents
+    int stall;        ///< generations without improvement of the best tour before stopping
+    double timeLimit; ///< in seconds
+    unsigned seed;
+    long long target; ///< stops as soon as a tour of this cost is found (-1: none)
+    bool verbose;
+};
+
+struct MemeticResult
+{
+    std::vector<int> succ;
+    long long cost;
+    long generations;
+    long offspring; ///< children that replaced their parent
+    double entropy; ///< of the arcs of the final population
+    double seconds;
+};
+
+MemeticResult memetic(const std::vector<std::vector<int>> &c, const MemeticOptions &options);
+
+// --- crossover ---
+
+// the k cheapest successors of each city, the candidate arcs of the subtour merging
+std::vector<std::vector<int>> nearLists(const std::vector<std::vector<int>> &c, int k);
+
+// AB-cycles of the parents A and B: in a directed tour each city leaves by one
+// arc of A and is entered by one arc of B, so alternating an arc of A forward and
+// an arc of B backward follows v -> predB[succA[v]]. The AB-cycles are the cycles
+// of this permutation longer than one city (a fixed city is an arc of A and B).
+std::vector<std::vector<int>> abCycles(const std::vector<int> &succA, const std::vector<int> &predB);
+
+struct EaxScratch
+{
+    std::vector<int> pred, cycle, members, sizes;
+};
+
+// child of A where the arcs of A of the AB-cycle are replaced by its arcs of B,
+// the subtours being merged, smallest first, by the cheapest exchange of
+// successors among the near lists. Returns the cost of the child minus the cost
+// of A; changed receives cities whose successor may differ from A.
+long long eaxChild(const std::vector<std::vector<int>> &c, const std::vector<std::vector<int>> &near, const std::vector<int> &succA, const std::vector<int> &predB,
+                   const std::vector<int> &abCycle, std::vector<int> &child, std::vector<int> &changed, EaxScratch &scratch);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include "config.hpp"
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+// Memory use of a run, printed as fields of the Result line: the peak resident
+// set size of the process, the arrays of variables of the models (n^3 GRBVar
+// for the flow models) and the time spent allocating them. Before building its
+// model, each model also predicts the memory it will take, so that a run beyond
+// the budget of the option "memory-budget=<MB>" is downsized or refused.
+
+void recordAllocation(size_t bytes, double seconds);
+
+// new T[count](), counted in the memory fields
+template <class T>
+T *trackedArray(size_t count)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    T *array = new T[count]();
+    recordAllocation(count * sizeof(T), std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    return array;
+}
+
+// peak resident set size of the process in MB (0 if unknown)
+double peakRss();
+// "peak rss = 512.3 MB; variable arrays = 120.5 MB; allocation time = 0.02 sec"
+std::string memoryFields();
+
+// rough memory of a model of vars variables and nonzeros coefficients solved
+// on threads threads, in MB: each thread works on its own copy of the matrix
+double predictedMemory(long long vars, long long nonzeros, int threads);
+// with the option "memory-budget", lowers the threads of the configuration
+// until the prediction fits the budget; refuses the run (a "Refused:" line,
+// then exit) if it does not fit on one thread
+void fitMemoryBudget(Config &config, long long vars, long long nonzeros);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef MULTISTART_HPP
+#define MULTISTART_HPP
+
+#include <vector>
+
+// Multi-start heuristic: randomised constructions followed by Or-opt, run on
+// every core by a work-stealing pool (see pool.hpp). Even starts build a
+// randomised nearest neighbour tour, odd starts kick (double bridge) the best
+// tour found so far. Each worker has its own random stream and scratch arrays;
+// the best tour is shared through a lock-free slot updated by compare-and-swap.
+// With keep, each worker also keeps its cheapest distinct tours, merged at the
+// end (for tour merging, see sousTours.cpp).
+
+struct MultiStartOptions
+{
+    int threads;
+    long starts;      ///< number of starts, 0 to run until the time limit
+    double timeLimit; ///< in seconds
+    unsigned seed;
+    int candidates;   ///< cities considered at each step of the randomised construction
+    int keep;         ///< distinct tours returned in tours, 0 for the best one only
+};
+
+struct MultiStartResult
+{
+    std::vector<int> succ;
+    long long cost;
+    std::vector<std::vector<int>> tours; ///< the keep cheapest distinct tours, cheapest first
+    long starts;       ///< starts completed
+    long improvements; ///< starts that improved the shared best tour
+    long steals;       ///< tasks taken by a worker from another one's deque
+    double seconds;
+};
+
+MultiStartResult multiStart(const std::vector<std::vector<int>> &c, const MultiStartOptions &options);
+
+#endif
@@ -6,8 +6,12 @@
 #include <fstream>
 #include <vector>
 
+// cost used by the instances for forbidden arcs (always the diagonal, sometimes more)
+const int forbiddenCost = 100000000;
+
 void openFile(std::ifstream &file, std::string filePath);
 std::vector<std::vector<int>> processFile(std::ifstream &file);
 std::vector<std::vector<int>> parse(std::string filePath);
+bool isSymmetric(const std::vector<std::vector<int>> &matrix);
 
 #endif
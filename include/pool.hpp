@@ -0,0 +1,55 @@
+#ifndef POOL_HPP
+#define POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool of a fixed number of threads. Each worker has its own
+// deque of tasks: it runs them from the back (last submitted first, still warm
+// in its cache) and, when it is empty, steals from the front of the others.
+// A task receives the index of the worker running it, so that it can use
+// per-worker data (random generator, scratch arrays) without locking.
+class TaskPool
+{
+public:
+    typedef std::function<void(int)> Task;
+
+    explicit TaskPool(int threads);
+    ~TaskPool();
+
+    // from a task, the new task goes to the deque of the current worker;
+    // from outside the pool, the deques are filled in turn
+    void submit(Task task);
+    // blocks until every submitted task (and the tasks they submitted) is done
+    void wait();
+    int size() const;
+    long steals() const;
+
+private:
+    struct Worker
+    {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::mutex idleLock;
+    std::condition_variable wake;   ///< a task was queued, or the pool stops
+    std::condition_variable idle;   ///< no task is pending any more
+    std::atomic<long> queued;       ///< tasks in the deques
+    std::atomic<long> pending;      ///< tasks submitted and not finished
+    std::atomic<long> stolen;
+    std::atomic<unsigned> nextWorker;
+    bool stopping;
+
+    bool take(int w, Task &task);
+    void run(int w);
+};
+
+#endif
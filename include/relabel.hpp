@@ -0,0 +1,33 @@
+#ifndef RELABEL_HPP
+#define RELABEL_HPP
+
+#include <string>
+#include <vector>
+
+// Relabelling of the cities for locality: the cities are numbered along a
+// heuristic tour, so that the cities next to each other in good tours are
+// next to each other in the rows of the matrix and a walk along a tour reads
+// the matrix near its diagonal instead of at random. The instances have no
+// coordinates for a space-filling order. Any model works on the relabelled
+// matrix as on the original; its tours are mapped back for the output.
+
+struct Relabelling
+{
+    std::vector<int> original; ///< city of the instance labelled v
+    std::vector<int> label;    ///< label of the city i of the instance
+};
+
+// along the tour of the nearest neighbour from city 0, improved by Or-opt:
+// city 0 keeps the label 0
+Relabelling localityRelabelling(const std::vector<std::vector<int>> &c);
+// the matrix of the relabelled instance: c'[v][w] = c[original[v]][original[w]]
+std::vector<std::vector<int>> relabelMatrix(const std::vector<std::vector<int>> &c, const Relabelling &r);
+// successor array of the relabelled instance in the labels of the instance
+std::vector<int> originalSuccessors(const std::vector<int> &succ, const Relabelling &r);
+
+// one line per label: the city of the instance it stands for
+bool writeRelabelling(std::string filePath, const Relabelling &r);
+// the labels of writeRelabelling; false if the file cannot be read or is not a permutation
+bool readRelabelling(std::string filePath, Relabelling &r);
+
+#endif
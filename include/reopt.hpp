@@ -0,0 +1,48 @@
+#ifndef REOPT_HPP
+#define REOPT_HPP
+
+#include "gurobi_c++.h"
+#include "graph.hpp"
+#include <string>
+#include <vector>
+
+// Re-optimisation of sousTours.cpp when a few arc costs change (--delta): the
+// model is kept and only the objective coefficients and bounds of the changed
+// arcs are modified; the subtour constraints found so far are added to it (they
+// do not depend on the costs) and the previous tour is the MIP start.
+// Across runs, the tour and the subtour constraints are saved in a checkpoint
+// (--save-state, see checkpoint.hpp) and read back (--reopt) instead of solving
+// the instance again.
+
+// new cost of the arc (i,j); a cost of at least forbiddenCost closes the arc
+struct ArcChange
+{
+    int i, j, cost;
+};
+typedef std::vector<ArcChange> Delta;
+
+// "i j cost" lines, '#' starting a comment; blank lines separate the deltas,
+// which are applied one after the other (their costs replace those of the instance)
+std::vector<Delta> readDeltas(std::string filePath);
+void applyDelta(std::vector<std::vector<int>> &c, const Delta &delta);
+
+// the reduction of buildGraph (graph.hpp) must stay valid for every delta:
+// returns the widening of its gap and the changed arcs, that the graph keeps
+// anyway. A tour costs at most the sum of the increases more after a delta, and
+// any arc at most the sum of the decreases less, so this sum over the changes of
+// a delta is enough. Returns -1 (no reduction) if a delta opens or closes an
+// arc: the assignment bound then says nothing about the tours through it.
+long long deltaSlack(const std::vector<std::vector<int>> &c, const std::vector<Delta> &deltas, std::vector<std::pair<int, int>> &changed);
+
+// sets the objective coefficient and bounds of the changed arcs of the graph to
+// their cost in c; returns the number of variables modified
+int updateCosts(GRBVar *x, const Graph &g, const std::vector<std::vector<int>> &c, const Delta &delta);
+// adds the subtour constraints cuts[from..] to the model
+void addSubtourConstraints(GRBModel &model, const GRBVar *x, const Graph &g, const std::vector<std::vector<int>> &cuts, size_t from);
+// the bound of a checkpoint as a constraint: a tour costs at least the bound
+// rounded up (the costs are integers); only valid for the costs it was found with
+void addBoundConstraint(GRBModel &model, const GRBVar *x, const Graph &g, double bound);
+// the tour as MIP start; false if one of its arcs is not in the graph or is closed
+bool setTourStart(GRBVar *x, const Graph &g, const std::vector<int> &succ, bool symmetric);
+
+#endif
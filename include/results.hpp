@@ -0,0 +1,22 @@
+#ifndef RESULTS_HPP
+#define RESULTS_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+
+// one "Result: <instance>; key = value; ..." line printed by a model
+struct RunResult
+{
+    std::string instance;                      ///< file name of the instance, without its directory
+    std::map<std::string, std::string> fields; ///< every "key = value" pair of the line
+    double runtime;                            ///< in seconds, the unit is stripped
+    double objective;
+};
+
+bool parseResultLine(std::string line, RunResult &result);
+// reads every Result line of a results.csv (grep output) or of a runner log;
+// a directory stands for the results.csv it contains
+std::vector<RunResult> readResults(std::string path);
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef SEPARATION_HPP
+#define SEPARATION_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// separation routines of the callbacks, written on plain arrays of variable
+// values so that they can be benchmarked (and tested) without Gurobi
+
+// x is the n x n solution of an assignment based model, stored row-major
+
+// successor of each city in an integer solution (-1 if it has none)
+std::vector<int> integerSuccessors(const double *x, int n);
+// cities of the cycle through city 0 when it is not a full tour, empty otherwise (sousTours.cpp)
+std::vector<int> subtourFromSolution(const double *x, int n);
+// cities reached from city 0 following the first arc with a positive value (sousTours_cut.cpp)
+std::vector<int> subtourFromRelaxation(const double *x, int n);
+// left-hand side of the subtour constraint sum_{i,j in S} x(i,j) <= |S| - 1
+double subtourLhs(const double *x, int n, const std::vector<int> &S);
+
+// x is the n x n solution of the undirected model of symmetric instances, where
+// only the upper triangle (i < j) is used
+
+// connected components of the edges taken in an integer solution
+std::vector<std::vector<int>> edgeComponents(const double *x, int n);
+
+// lifted cycle inequalities D_k+ and D_k- of Grötschel and Padberg on a sequence
+// of distinct cities (i1, ..., ik), k >= 3, both of the form
+//   sum_{h<k} x(ih,ih+1) + x(ik,i1) + lifting <= k - 1
+// D_k+ lifting: 2 sum_{h=3..k} x(i1,ih) + sum_{h=4..k} sum_{j=3..h-1} x(ih,ij)
+// D_k- lifting: 2 sum_{h=2..k-1} x(ih,i1) + sum_{h=3..k-1} sum_{j=2..h-1} x(ih,ij)
+// (x is the n x n relaxation, sousTours_cut.cpp)
+
+struct LiftedCycleCut
+{
+    std::vector<int> sequence;
+    bool plus; ///< D_k+ or D_k-
+    double violation;
+};
+
+double liftedCycleLhs(const double *x, int n, const std::vector<int> &sequence, bool plus);
+// arcs (tail, head) of the inequality with their coefficients, the right-hand side being k - 1
+void liftedCycleCoefficients(const std::vector<int> &sequence, bool plus, std::vector<std::pair<int, int>> &arcs, std::vector<int> &coefficients);
+// heuristic separation: depth-first search of the paths of the support graph
+// (x > 0) with at most maxLength cities and a lifted weight within 1 of their
+// number of arcs; each path is closed into a cycle and lifted both ways. Stops after
+// budget seconds and returns the (at most maxCuts) most violated inequalities.
+std::vector<LiftedCycleCut> liftedCycleViolations(const double *x, int n, int maxLength, double budget, int maxCuts);
+
+// x is the n x n x n relaxation of the improved flow model, x[(i * n + j) * n + k]
+// being the value of the arc (i,j) taken at position k (flot_callback.cpp)
+
+struct FlotCut
+{
+    int i, j, k;
+    double violation;
+};
+
+bool flotArc(int i, int j, int k, int n);
+// linking inequalities x(i,j,k) <= sum_l x(j,l,k+1) violated by more than 1e-6 by the relaxation
+std::vector<FlotCut> flotLinkingViolations(const double *x, int n);
+
+// relaxation fixtures: the first line holds the number of cities and the
+// number of indices (2 or 3), then one "index value" line per nonzero entry
+void writeRelaxation(std::string filePath, const std::vector<double> &x, int n, int dims);
+std::vector<double> readRelaxation(std::string filePath, int &n, int &dims);
+
+#endif
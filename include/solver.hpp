@@ -0,0 +1,24 @@
+#ifndef SOLVER_HPP
+#define SOLVER_HPP
+
+#include "gurobi_c++.h"
+#include "config.hpp"
+#include <string>
+
+// Gurobi side of the run configuration (see config.hpp)
+
+// applies the time limit, the threads and the Gurobi parameters of the
+// configuration to the model; with the "tune" option, first applies the tuned
+// parameters of the (formulation, size class) pair, running the tuning tool and
+// caching its best parameter set on disk when there is none yet.
+// The tuning tool ignores callbacks: models relying on lazy constraints are
+// tuned on their relaxation without them.
+void configure(GRBModel &model, const Config &config, std::string formulation, int n);
+// "status = optimal; vars = 28900; constrs = 340; nonzeros = 57800; " followed
+// by the memory fields of the run (see memory.hpp), for the Result line; the
+// status is "optimal", "time limit", "interrupted" or the Gurobi status code
+std::string resourceFields(GRBModel &model);
+// size class of an instance of n cities for the tuning cache ("n64-127")
+std::string sizeClass(int n);
+
+#endif
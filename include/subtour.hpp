@@ -0,0 +1,66 @@
+#ifndef SUBTOUR_HPP
+#define SUBTOUR_HPP
+
+#include "gurobi_c++.h"
+#include "callback.hpp"
+#include "graph.hpp"
+#include <atomic>
+#include <vector>
+
+// subtour elimination model of sousTours.cpp: one binary variable per arc of
+// the graph, degree constraints, and subtour constraints added as lazy
+// constraints by the callbacks below (LazyConstraints must be set).
+// On symmetric instances the arcs of the graph are edges (tail < head).
+
+// directed model: cuts the cycle through city 0 of an integer solution when it is not a tour
+class SubtourCallback : public ModelCallback
+{
+public:
+    GRBVar *x;
+    const Graph *g;
+    int n;
+    std::vector<std::vector<int>> cuts; ///< sets of the subtour constraints added, kept for a re-optimisation
+    const std::atomic<bool> *cancel;    ///< when set, the solve is aborted at the next event
+
+    SubtourCallback(GRBVar *_x, const Graph *_g, const std::atomic<bool> *_cancel = nullptr);
+
+protected:
+    void separate();
+    void saveCuts(Checkpoint &checkpoint) const;
+};
+
+// undirected model: cuts every connected component of an integer solution that is not a tour
+class UndirectedSubtourCallback : public ModelCallback
+{
+public:
+    GRBVar *x;
+    const Graph *g;
+    int n;
+    std::vector<std::vector<int>> cuts; ///< sets of the subtour constraints added, kept for a re-optimisation
+
+    UndirectedSubtourCallback(GRBVar *_x, const Graph *_g);
+
+protected:
+    void separate();
+    void saveCuts(Checkpoint &checkpoint) const;
+};
+
+// left-hand side of the subtour constraint of S: the arcs (edges) of g inside S
+GRBLinExpr insideArcs(const Graph &g, const GRBVar *x, const std::vector<int> &S);
+// adds the variables (to be deleted[] by the caller), the objective and the
+// degree constraints of the model of the graph g; arcs of forbidden cost get an upper bound of 0
+GRBVar *buildSubtourModel(GRBModel &model, const Graph &g, bool symmetric, bool verbose = false);
+// successor of each city in the solution of the model; the edges of the
+// undirected model are oriented along the tour starting from city 0
+std::vector<int> subtourSolution(const Graph &g, const GRBVar *x, bool symmetric);
+
+// repair operator of the LNS (see lns.hpp): solves the directed model of c with
+// one thread for at most timeLimit seconds, looking for a tour better than succ.
+// Returns true and replaces succ if one is found; optimal tells whether the
+// returned (or the given) tour is proven optimal. Setting cancel stops the solve
+// as the time limit would. The GRBException of a failed solve is passed on to the
+// caller; nothing is written to stdout.
+bool solveSubtour(GRBEnv &env, const std::vector<std::vector<int>> &c, double timeLimit, std::vector<int> &succ, bool &optimal,
+                  const std::atomic<bool> *cancel = nullptr);
+
+#endif
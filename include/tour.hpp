@@ -0,0 +1,20 @@
+#ifndef TOUR_HPP
+#define TOUR_HPP
+
+#include <utility>
+#include <vector>
+
+// a tour is stored either as the ordered list of its cities (tour[0] is the
+// starting city) or as a successor array (succ[i] is the city visited after i)
+
+long long tourCost(const std::vector<std::vector<int>> &c, const std::vector<int> &tour);
+long long successorCost(const std::vector<std::vector<int>> &c, const std::vector<int> &succ);
+std::vector<int> tourToSuccessors(const std::vector<int> &tour);
+std::vector<int> successorsToTour(const std::vector<int> &succ, int start = 0);
+std::vector<int> cycleFrom(const std::vector<int> &succ, int start);
+std::vector<std::vector<int>> cycles(const std::vector<int> &succ);
+// arcs (i, succ[i]) of the given tours, sorted and without duplicates;
+// frequency[k] is the number of tours using the arc k
+std::vector<std::pair<int, int>> tourUnion(const std::vector<std::vector<int>> &tours, std::vector<int> &frequency);
+
+#endif
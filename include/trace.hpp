@@ -0,0 +1,57 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <string>
+#include <vector>
+
+// progress of a branch and bound run, sampled by the callbacks (see callback.hpp)
+// to compare formulations on their anytime behaviour and not only on their final gap
+
+// state of the solver at some time; a missing incumbent (bound) is +infinity (-infinity)
+struct TracePoint
+{
+    double time;
+    double incumbent;
+    double bound;
+    double nodes;
+};
+
+// primal-dual gap of Berthold: 0 when the bounds meet, 1 when there is no
+// incumbent or the bounds have different signs, |incumbent - bound| / max(|incumbent|, |bound|) otherwise
+double primalDualGap(double incumbent, double bound);
+
+// the samples are kept in a fixed size ring buffer, only when the incumbent or
+// the bound changes; the primal-dual integral (integral of the gap over time) is
+// accumulated at every sample, so that it stays exact when old samples are overwritten
+class Trace
+{
+public:
+    Trace(size_t capacity = 4096);
+
+    void record(double time, double incumbent, double bound, double nodes);
+    // last sample, with the final state of the model, closing the integral
+    void finish(double time, double incumbent, double bound, double nodes);
+
+    double primalDualIntegral() const;
+    // best bound sampled before the first branching (-infinity if none)
+    double rootBound() const;
+    // samples still in the buffer, oldest first
+    std::vector<TracePoint> points() const;
+    // number of samples overwritten by newer ones
+    size_t dropped() const;
+    // "time,incumbent,bound,nodes,gap" lines, missing values are left empty
+    bool writeCsv(std::string filePath) const;
+
+private:
+    std::vector<TracePoint> buffer;
+    size_t next;  ///< position of the next sample in the buffer
+    size_t count; ///< number of samples ever stored
+    TracePoint last;
+    double integral;
+    double root;
+    bool started;
+
+    void store(const TracePoint &point);
+};
+
+#endif
@@ -0,0 +1,27 @@
+# usage : ./scaling.sh sol_dir [family] [seed] [models...]
+#
+# Scaling campaign: generates one synthetic instance of the given family for
+# each size of SIZES (default 200 500 1000 2000 5000) and runs every model on
+# them through benchmark.sh. The results end up in sol_dir/<model>/results.csv.
+
+family=${2:-ftv}
+seed=${3:-1}
+shift $(( $# < 3 ? $# : 3 ))
+models=${@:-"sousTours mtz flot_callback"}
+sizes=${SIZES:-"200 500 1000 2000 5000"}
+
+data=scaling_data/$family
+mkdir -p build/$data
+
+echo Scaling study: $family instances, sizes $sizes
+for n in $sizes ; do
+    instance=build/$data/${family}${n}.dat
+    if [ ! -f $instance ] ; then
+        echo Generation of $instance
+        ./build/gen.out $family $n $seed $instance
+    fi
+done
+
+for model in $models ; do
+    ./benchmark.sh $data $1/$model $model
+done
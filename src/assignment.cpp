@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <limits>
+#include "assignment.hpp"
+#include "parser.hpp"
+
+// Hungarian algorithm with shortest augmenting paths, O(n^3)
+// (rows and columns are shifted by one, index 0 being the virtual start);
+// the diagonal is always forbidden, whatever the instance file says
+Assignment solveAssignment(const std::vector<std::vector<int>> &c)
+{
+    const long long infinity = std::numeric_limits<long long>::max() / 4;
+    int n = c.size();
+    std::vector<long long> u(n + 1, 0), v(n + 1, 0), minv(n + 1);
+    std::vector<int> p(n + 1, 0), way(n + 1, 0);
+    std::vector<char> used(n + 1);
+
+    for (int i = 1; i <= n; ++i)
+    {
+        p[0] = i;
+        int j0 = 0;
+        std::fill(minv.begin(), minv.end(), infinity);
+        std::fill(used.begin(), used.end(), 0);
+        do
+        {
+            used[j0] = 1;
+            int i0 = p[j0], j1 = 0;
+            long long delta = infinity;
+            const std::vector<int> &row = c[i0 - 1];
+            for (int j = 1; j <= n; ++j)
+            {
+                if (used[j])
+                    continue;
+                long long current = (j == i0 ? forbiddenCost : row[j - 1]) - u[i0] - v[j];
+                if (current < minv[j])
+                {
+                    minv[j] = current;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta)
+                {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= n; ++j)
+            {
+                if (used[j])
+                {
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                }
+                else
+                {
+                    minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (p[j0] != 0);
+        do
+        {
+            int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while (j0);
+    }
+
+    Assignment a;
+    a.succ.assign(n, -1);
+    a.u.assign(u.begin() + 1, u.end());
+    a.v.assign(v.begin() + 1, v.end());
+    a.cost = 0;
+    for (int j = 1; j <= n; ++j)
+    {
+        a.succ[p[j] - 1] = j - 1;
+        a.cost += p[j] == j ? forbiddenCost : c[p[j] - 1][j - 1];
+    }
+    return a;
+}
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <limits>
+#include "balas.hpp"
+#include "heuristic.hpp"
+#include "tour.hpp"
+
+BalasSimonettiTable::BalasSimonettiTable(int _k)
+{
+    k = std::min(std::max(_k, 2), 16);
+    masks = 1 << (k - 1);
+    next.assign((size_t)masks * k, -1);
+    shift.assign((size_t)masks * k, 0);
+    // the offset t in 1..k-1 is the bit t - 1 of a mask
+    for (int mask = 0; mask < masks; ++mask)
+    {
+        // placing m moves m to the first unplaced position s after it
+        int s = 1;
+        while (s < k && (mask >> (s - 1) & 1))
+            ++s;
+        next[mask * k] = mask >> s;
+        shift[mask * k] = s;
+        for (int e = 1; e < k; ++e)
+        {
+            if (!(mask >> (e - 1) & 1))
+                next[mask * k + e] = mask | 1 << (e - 1);
+        }
+    }
+}
+
+bool balasSimonetti(const std::vector<std::vector<int>> &c, std::vector<int> &succ, const BalasSimonettiTable &table, int start)
+{
+    int n = succ.size();
+    int k = table.k;
+    if (n < 4)
+        return false;
+    std::vector<int> order = successorsToTour(succ, start);
+    const long long infinity = std::numeric_limits<long long>::max() / 4;
+    int width = 2 * k;
+    size_t stage = (size_t)table.masks * width;
+    // costs of the stages m..m+k in a ring, predecessors (d + k) of every stage
+    std::vector<long long> cost((size_t)(k + 1) * stage, infinity);
+    std::vector<signed char> from((size_t)(n + 1) * stage, 0);
+    // m = 1, no city placed after it, the last one placed being the first city (d = -1)
+    cost[(1 % (k + 1)) * stage + k - 1] = 0;
+
+    for (int m = 1; m < n; ++m)
+    {
+        long long *current = cost.data() + (m % (k + 1)) * stage;
+        for (int mask = 0; mask < table.masks; ++mask)
+        {
+            for (int d = -k; d < k; ++d)
+            {
+                long long value = current[mask * width + d + k];
+                if (value >= infinity)
+                    continue;
+                const std::vector<int> &row = c[order[m + d]];
+                for (int e = 0; e < k && m + e < n; ++e)
+                {
+                    int nextMask = table.next[mask * k + e];
+                    if (nextMask < 0)
+                        continue;
+                    int s = table.shift[mask * k + e];
+                    int d2 = s > 0 ? -s : e;
+                    size_t state = (size_t)nextMask * width + d2 + k;
+                    long long &target = cost[((m + s) % (k + 1)) * stage + state];
+                    long long candidate = value + row[order[m + e]];
+                    if (candidate < target)
+                    {
+                        target = candidate;
+                        from[(size_t)(m + s) * stage + state] = (signed char)(d + k);
+                    }
+                }
+            }
+        }
+        // the ring slot of m is the one of m + k + 1
+        std::fill(current, current + stage, infinity);
+    }
+
+    // back to the first city from the last one placed
+    const long long *closing = cost.data() + (n % (k + 1)) * stage;
+    long long best = infinity;
+    int bestD = 0;
+    for (int d = -k; d < 0; ++d)
+    {
+        if (n + d < 1 || closing[d + k] >= infinity)
+            continue;
+        long long total = closing[d + k] + c[order[n + d]][order[0]];
+        if (total < best)
+        {
+            best = total;
+            bestD = d;
+        }
+    }
+    if (best >= tourCost(c, order))
+        return false;
+
+    std::vector<int> reordered(n);
+    reordered[0] = order[0];
+    int m = n, mask = 0, d = bestD;
+    for (int p = n - 1; p >= 1; --p)
+    {
+        reordered[p] = order[m + d];
+        int previous = from[(size_t)m * stage + (size_t)mask * width + d + k] - k;
+        if (d > 0)
+            mask &= ~(1 << (d - 1));
+        else
+        {
+            int s = -d;
+            m -= s;
+            mask = ((1 << (s - 1)) - 1) | mask << s;
+        }
+        d = previous;
+    }
+    succ = tourToSuccessors(reordered);
+    return true;
+}
+
+int balasSimonettiSearch(const std::vector<std::vector<int>> &c, std::vector<int> &succ, const BalasSimonettiTable &table, std::mt19937 &rng,
+                         int failures)
+{
+    std::uniform_int_distribution<int> city(0, (int)succ.size() - 1);
+    int improvements = 0;
+    for (int failed = 0; failed < failures;)
+    {
+        if (balasSimonetti(c, succ, table, city(rng)))
+        {
+            orOpt(c, succ);
+            improvements++;
+            failed = 0;
+        }
+        else
+            failed++;
+    }
+    return improvements;
+}
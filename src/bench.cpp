@@ -0,0 +1,977 @@
+#include "assignment.hpp"
+#include "balas.hpp"
+#include "cutstats.hpp"
+#include "graph.hpp"
+#include "heuristic.hpp"
+#include "incumbent.hpp"
+#include "kernels.hpp"
+#include "memetic.hpp"
+#include "multistart.hpp"
+#include "parser.hpp"
+#include "relabel.hpp"
+#include "separation.hpp"
+#include "tour.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <regex>
+#include <thread>
+using namespace std;
+
+// Microbenchmarks of the hot kernels of the project, in the spirit of Google
+// Benchmark (same command line flags and same JSON output, so that its
+// compare.py can be used to compare two commits) but without the dependency.
+//
+// usage : ./bench.out [--data=TSP_data] [--fixture=file]... [--benchmark_filter=regex]
+//                     [--benchmark_min_time=0.2] [--benchmark_out=results.json]
+//         ./bench.out --check   (checks the optimised routines against references, exits with 1 on a failure)
+
+struct State
+{
+    long long iterations;
+    long long items;  ///< items processed per iteration (0 if not relevant)
+    long long bytes;  ///< bytes processed per iteration (0 if not relevant)
+};
+
+struct Benchmark
+{
+    string name;
+    function<void(State &)> run;
+};
+
+struct Measure
+{
+    string name;
+    long long iterations;
+    double realTime; ///< ns per iteration
+    double cpuTime;  ///< ns per iteration
+    long long items;
+    long long bytes;
+};
+
+static vector<Benchmark> benchmarks;
+static volatile long long sink; ///< keeps the compiler from removing the benchmarked code
+
+static void registerBenchmark(string name, function<void(State &)> run)
+{
+    Benchmark b;
+    b.name = name;
+    b.run = run;
+    benchmarks.push_back(b);
+}
+
+static Measure measure(const Benchmark &b, double minTime)
+{
+    State state;
+    state.iterations = 1;
+    b.run(state); // untimed, builds the fixtures of the benchmark
+    while (true)
+    {
+        state.items = 0;
+        state.bytes = 0;
+        clock_t cpuStart = clock();
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        b.run(state);
+        double real = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        double cpu = double(clock() - cpuStart) / CLOCKS_PER_SEC;
+        if (real >= minTime || state.iterations >= 1000000000LL)
+        {
+            Measure m;
+            m.name = b.name;
+            m.iterations = state.iterations;
+            m.realTime = real * 1e9 / state.iterations;
+            m.cpuTime = cpu * 1e9 / state.iterations;
+            m.items = state.items;
+            m.bytes = state.bytes;
+            return m;
+        }
+        // aim a bit above the minimum time, as Google Benchmark does
+        double factor = real > 0 ? 1.4 * minTime / real : 10.0;
+        state.iterations = max(state.iterations + 1, (long long)(state.iterations * min(factor, 10.0)));
+    }
+}
+
+// --- fixtures ---
+
+// a fixture built by the first benchmark run that uses it, the copies sharing
+// it, so that the benchmarks left out by the filter cost nothing
+template <typename T>
+class Lazy
+{
+public:
+    Lazy(function<T()> make) : data(make_shared<Data>()) { data->make = make; }
+    const T &operator*() const
+    {
+        if (!data->value)
+            data->value.reset(new T(data->make()));
+        return *data->value;
+    }
+    const T *operator->() const { return &**this; }
+
+private:
+    struct Data
+    {
+        function<T()> make;
+        unique_ptr<T> value;
+    };
+    shared_ptr<Data> data;
+};
+
+typedef Lazy<vector<vector<int>>> LazyMatrix;
+
+static vector<vector<int>> randomMatrix(int n, unsigned seed)
+{
+    mt19937 rng(seed);
+    uniform_int_distribution<int> cost(1, 1000);
+    vector<vector<int>> c(n, vector<int>(n));
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            c[i][j] = i == j ? 100000000 : cost(rng);
+    return c;
+}
+
+static vector<int> randomTour(int n, mt19937 &rng)
+{
+    vector<int> tour(n);
+    iota(tour.begin(), tour.end(), 0);
+    shuffle(tour.begin() + 1, tour.end(), rng);
+    return tour;
+}
+
+// a random cycle cover made of cycles of 2 to maxLength cities
+static vector<int> randomCycleCover(int n, int maxLength, mt19937 &rng)
+{
+    vector<int> order = randomTour(n, rng);
+    vector<int> succ(n);
+    int start = 0;
+    while (start < n)
+    {
+        int length = min(n - start, 2 + (int)(rng() % (maxLength - 1)));
+        if (n - start - length == 1)
+            length++;
+        for (int k = 0; k < length; ++k)
+            succ[order[start + k]] = order[start + (k + 1) % length];
+        start += length;
+    }
+    return succ;
+}
+
+// the integer solutions seen by the MIPSOL callback: covers by short cycles
+static vector<double> cycleCoverSolution(int n, mt19937 &rng)
+{
+    vector<double> x((size_t)n * n, 0.0);
+    vector<int> succ = randomCycleCover(n, 8, rng);
+    for (int i = 0; i < n; ++i)
+        x[(size_t)i * n + succ[i]] = 1.0;
+    return x;
+}
+
+// assignment relaxations are mostly convex combinations of a few cycle covers
+static vector<double> assignmentRelaxation(int n, mt19937 &rng)
+{
+    vector<double> x((size_t)n * n, 0.0);
+    const double weights[] = {0.5, 0.3, 0.2};
+    for (double w : weights)
+    {
+        vector<int> succ = randomCycleCover(n, n / 2 + 2, rng);
+        for (int i = 0; i < n; ++i)
+            x[(size_t)i * n + succ[i]] += w;
+    }
+    return x;
+}
+
+// layered flow relaxations look like a few tours spread over the positions
+static vector<double> flotRelaxation(int n, mt19937 &rng)
+{
+    vector<double> x((size_t)n * n * n, 0.0);
+    const double weights[] = {0.6, 0.4};
+    for (double w : weights)
+    {
+        vector<int> tour = randomTour(n, rng);
+        for (int k = 0; k < n; ++k)
+            x[((size_t)tour[k] * n + tour[(k + 1) % n]) * n + k] += w;
+    }
+    return x;
+}
+
+struct Relaxations
+{
+    int n;
+    vector<double> integer;    ///< n x n
+    vector<double> assignment; ///< n x n
+    vector<double> flot;       ///< n x n x n
+};
+
+struct EaxFixture
+{
+    vector<vector<int>> near;
+    vector<int> a, predB;
+    vector<vector<int>> abCycles;
+};
+
+// two locally optimal tours and their AB-cycles
+static EaxFixture eaxFixture(const vector<vector<int>> &c)
+{
+    int n = c.size();
+    EaxFixture f;
+    f.near = nearLists(c, 10);
+    mt19937_64 rng(3);
+    vector<int> b;
+    vector<char> visited;
+    randomNearestNeighbour(c, rng, 3, f.a, visited);
+    orOpt(c, f.a);
+    randomNearestNeighbour(c, rng, 3, b, visited);
+    orOpt(c, b);
+    f.predB.resize(n);
+    for (int v = 0; v < n; ++v)
+        f.predB[b[v]] = v;
+    f.abCycles = abCycles(f.a, f.predB);
+    return f;
+}
+
+struct RelabelFixture
+{
+    vector<vector<int>> c; ///< the relabelled costs
+    vector<int> succ;      ///< the tour in the new labels
+    vector<double> x;      ///< a relaxation whose support follows the tour
+};
+
+// a good tour kicked away from its local optimum
+static vector<int> kickedTour(const vector<vector<int>> &c)
+{
+    mt19937_64 kicks(9);
+    vector<int> succ = nearestNeighbour(c, 0), scratch;
+    orOpt(c, succ);
+    doubleBridge(succ, kicks, scratch);
+    doubleBridge(succ, kicks, scratch);
+    return succ;
+}
+
+// the instance with its cities in random order, or relabelled along a tour
+static RelabelFixture relabelFixture(const vector<vector<int>> &c, const vector<int> &tourSucc, bool relabelled)
+{
+    int n = c.size();
+    Relabelling l;
+    if (relabelled)
+        l = localityRelabelling(c);
+    else
+    {
+        mt19937 rng(5);
+        l.original.resize(n);
+        iota(l.original.begin(), l.original.end(), 0);
+        shuffle(l.original.begin(), l.original.end(), rng);
+    }
+    l.label.assign(n, 0);
+    for (int v = 0; v < n; ++v)
+        l.label[l.original[v]] = v;
+    RelabelFixture f;
+    f.c = relabelMatrix(c, l);
+    f.succ.resize(n);
+    for (int i = 0; i < n; ++i)
+        f.succ[l.label[i]] = l.label[tourSucc[i]];
+    // half the tour and half a cover by cycles of 8 consecutive cities of the tour
+    vector<int> tour = successorsToTour(f.succ, 0);
+    f.x.assign((size_t)n * n, 0.0);
+    for (int k = 0; k < n; ++k)
+    {
+        int block = k / 8 * 8;
+        int next = k % 8 == 7 || k + 1 == n ? block : k + 1;
+        f.x[(size_t)tour[k] * n + tour[(k + 1) % n]] += 0.5;
+        f.x[(size_t)tour[k] * n + tour[next]] += 0.5;
+    }
+    return f;
+}
+
+static string baseName(string path)
+{
+    size_t slash = path.find_last_of('/');
+    string name = slash == string::npos ? path : path.substr(slash + 1);
+    size_t dot = name.find('.');
+    return dot == string::npos ? name : name.substr(0, dot);
+}
+
+static bool fileExists(string path)
+{
+    ifstream file(path);
+    return file.is_open();
+}
+
+// --- benchmarks ---
+
+static void registerParser(string path)
+{
+    ifstream file(path, ios::binary | ios::ate);
+    long long size = file.tellg();
+    string name = baseName(path);
+
+    registerBenchmark("parse/" + name, [=](State &state) {
+        streambuf *old = cout.rdbuf(nullptr); // parse() reports the opening of the file
+        for (long long it = 0; it < state.iterations; ++it)
+            sink = parse(path).size();
+        cout.rdbuf(old);
+        state.bytes = size;
+    });
+    registerBenchmark("processFile/" + name, [=](State &state) {
+        ifstream file(path);
+        for (long long it = 0; it < state.iterations; ++it)
+        {
+            file.clear();
+            file.seekg(0);
+            sink = processFile(file).size();
+        }
+        state.bytes = size;
+    });
+}
+
+static void registerMatrix(string name, LazyMatrix cost)
+{
+    registerBenchmark("matrix/row_major/" + name, [=](State &state) {
+        const vector<vector<int>> &c = *cost;
+        int n = c.size();
+        for (long long it = 0; it < state.iterations; ++it)
+        {
+            long long sum = 0;
+            for (int i = 0; i < n; ++i)
+                for (int j = 0; j < n; ++j)
+                    sum += c[i][j];
+            sink = sum;
+        }
+        state.items = (long long)n * n;
+    });
+    registerBenchmark("matrix/column_major/" + name, [=](State &state) {
+        const vector<vector<int>> &c = *cost;
+        int n = c.size();
+        for (long long it = 0; it < state.iterations; ++it)
+        {
+            long long sum = 0;
+            for (int j = 0; j < n; ++j)
+                for (int i = 0; i < n; ++i)
+                    sum += c[i][j];
+            sink = sum;
+        }
+        state.items = (long long)n * n;
+    });
+    // the access pattern of a tour walk: one random row per step
+    Lazy<vector<int>> tour([=]() {
+        mt19937 rng(42);
+        return randomTour(cost->size(), rng);
+    });
+    Lazy<vector<int>> succ([=]() { return tourToSuccessors(*tour); });
+    registerBenchmark("tour/cost/" + name, [=](State &state) {
+        for (long long it = 0; it < state.iterations; ++it)
+            sink = tourCost(*cost, *tour);
+        state.items = tour->size();
+    });
+    registerBenchmark("tour/successor_cost/" + name, [=](State &state) {
+        for (long long it = 0; it < state.iterations; ++it)
+            sink = successorCost(*cost, *succ);
+        state.items = succ->size();
+    });
+}
+
+static void registerHeuristics(string name, LazyMatrix cost)
+{
+    registerBenchmark("assignment/" + name, [=](State &state) {
+        for (long long it = 0; it < state.iterations; ++it)
+            sink = solveAssignment(*cost).cost;
+        state.items = cost->size();
+    });
+    Lazy<vector<int>> cover([=]() { return solveAssignment(*cost).succ; });
+    registerBenchmark("heuristic/patch/" + name, [=](State &state) {
+        for (long long it = 0; it < state.iterations; ++it)
+        {
+            vector<int> succ = *cover;
+            patchCycles(*cost, succ);
+            sink = succ[0];
+        }
+        state.items = cost->size();
+    });
+    Lazy<vector<int>> start([=]() {
+        mt19937 rng(7);
+        return tourToSuccessors(randomTour(cost->size(), rng));
+    });
+    registerBenchmark("heuristic/or_opt/" + name, [=](State &state) {
+        for (long long it = 0; it < state.iterations; ++it)
+        {
+            vector<int> succ = *start;
+            orOpt(*cost, succ);
+            sink = succ[0];
+        }
+        state.items = cost->size();
+    });
+    registerBenchmark("graph/build/" + name, [=](State &state) {
+        for (long long it = 0; it < state.iterations; ++it)
+            sink = buildGraph(*cost).m;
+        state.items = (long long)cost->size() * cost->size();
+    });
+}
+
+// starts per second of the multi-start heuristic for 1, 2, 4, ... threads up to
+// the number of cores: it should grow about linearly
+static void registerMultiStart(string name, LazyMatrix cost)
+{
+    int cores = max(1u, thread::hardware_concurrency());
+    for (int threads = 1; threads <= cores; threads = threads < cores && threads * 2 > cores ? cores : threads * 2)
+    {
+        registerBenchmark("multistart/" + name + "/threads:" + to_string(threads), [=](State &state) {
+            MultiStartOptions options;
+            options.threads = threads;
+            options.starts = 32;
+            options.timeLimit = 1e9;
+            options.seed = 1;
+            options.candidates = 3;
+            options.keep = 0;
+            for (long long it = 0; it < state.iterations; ++it)
+                sink = multiStart(*cost, options).cost;
+            state.items = options.starts;
+        });
+        if (threads == cores)
+            break;
+    }
+}
+
+// one crossover of two locally optimal tours, over all their AB-cycles
+static void registerEax(string name, LazyMatrix cost)
+{
+    Lazy<EaxFixture> fixture([=]() { return eaxFixture(*cost); });
+    registerBenchmark("memetic/eax_child/" + name, [=](State &state) {
+        const EaxFixture &f = *fixture;
+        EaxScratch scratch;
+        vector<int> child, changed;
+        for (long long it = 0; it < state.iterations; ++it)
+        {
+            for (const vector<int> &abCycle : f.abCycles)
+                sink = eaxChild(*cost, f.near, f.a, f.predB, abCycle, child, changed, scratch);
+        }
+        state.items = f.abCycles.size();
+    });
+}
+
+// the kernels of kernels.hpp at each level the processor supports, the scalar
+// one being the baseline; the batches are of 64 cities
+static void registerKernels(string name, LazyMatrix cost)
+{
+    Lazy<CostMatrix> matrix([=]() { return CostMatrix(*cost); });
+    Lazy<vector<int>> tour([=]() {
+        mt19937 rng(11);
+        return randomTour(cost->size(), rng);
+    });
+    Lazy<vector<int>> cities([=]() { return vector<int>(tour->begin(), tour->begin() + min((int)tour->size(), 64)); });
+    // a segment of 3 cities taken out of the tour and tried everywhere
+    Lazy<vector<int>> rest([=]() { return vector<int>(tour->begin() + 3, tour->end()); });
+    for (int level = ScalarKernels; level <= supportedKernels(); ++level)
+    {
+        KernelLevel kernels = (KernelLevel)level;
+        string suffix = "/" + kernelName(kernels) + "/" + name;
+        registerBenchmark("kernels/tour_cost" + suffix, [=](State &state) {
+            setKernels(kernels);
+            for (long long it = 0; it < state.iterations; ++it)
+                sink = tourCostBatch(*matrix, *tour);
+            state.items = matrix->n;
+        });
+        registerBenchmark("kernels/insertion_deltas" + suffix, [=](State &state) {
+            setKernels(kernels);
+            vector<int> delta;
+            for (long long it = 0; it < state.iterations; ++it)
+            {
+                insertionDeltas(*matrix, *rest, (*tour)[0], (*tour)[2], delta);
+                sink = delta[0];
+            }
+            state.items = rest->size();
+        });
+        registerBenchmark("kernels/best_successors" + suffix, [=](State &state) {
+            setKernels(kernels);
+            vector<int> best;
+            for (long long it = 0; it < state.iterations; ++it)
+            {
+                bestSuccessors(*matrix, *cities, best);
+                sink = best[0];
+            }
+            state.items = (long long)cities->size() * matrix->n;
+        });
+        registerBenchmark("kernels/best_predecessors" + suffix, [=](State &state) {
+            setKernels(kernels);
+            vector<int> best;
+            for (long long it = 0; it < state.iterations; ++it)
+            {
+                bestPredecessors(*matrix, *cities, best);
+                sink = best[0];
+            }
+            state.items = (long long)cities->size() * matrix->n;
+        });
+    }
+}
+
+// one pass of the Balas-Simonetti program (see balas.hpp) from a nearest
+// neighbour tour, for k = 4..10: the time grows as k^2 2^k per city
+static void registerBalas(string name, LazyMatrix cost, int maxK)
+{
+    Lazy<vector<int>> start([=]() { return nearestNeighbour(*cost, 0); });
+    for (int k = 4; k <= maxK; k += 2)
+    {
+        shared_ptr<BalasSimonettiTable> table = make_shared<BalasSimonettiTable>(k);
+        registerBenchmark("balas/pass/k:" + to_string(k) + "/" + name, [=](State &state) {
+            for (long long it = 0; it < state.iterations; ++it)
+            {
+                vector<int> succ = *start;
+                balasSimonetti(*cost, succ, *table, 0);
+                sink = succ[0];
+            }
+            state.items = cost->size();
+        });
+    }
+}
+
+// the same search on the instance and on its relabelling along a heuristic tour
+// (see relabel.hpp): Or-opt from a kicked good tour, a walk along the tour and
+// the lifted cycle separation of a relaxation whose support follows the tour
+static void registerRelabel(string name, LazyMatrix cost)
+{
+    Lazy<vector<int>> tourSucc([=]() { return kickedTour(*cost); });
+    const char *labels[] = {"random", "relabelled"};
+    for (int m = 0; m < 2; ++m)
+    {
+        Lazy<RelabelFixture> fixture([=]() { return relabelFixture(*cost, *tourSucc, m == 1); });
+        string suffix = string("/") + labels[m] + "/" + name;
+        registerBenchmark("relabel/or_opt" + suffix, [=](State &state) {
+            const RelabelFixture &f = *fixture;
+            for (long long it = 0; it < state.iterations; ++it)
+            {
+                vector<int> s = f.succ;
+                orOpt(f.c, s);
+                sink = s[0];
+            }
+            state.items = f.succ.size();
+        });
+        registerBenchmark("relabel/tour_walk" + suffix, [=](State &state) {
+            const RelabelFixture &f = *fixture;
+            for (long long it = 0; it < state.iterations; ++it)
+                sink = successorCost(f.c, f.succ);
+            state.items = f.succ.size();
+        });
+        registerBenchmark("relabel/lifted_cycle" + suffix, [=](State &state) {
+            const RelabelFixture &f = *fixture;
+            int n = f.succ.size();
+            for (long long it = 0; it < state.iterations; ++it)
+                sink = liftedCycleViolations(f.x.data(), n, 6, 1e9, 20).size();
+            state.items = (long long)n * n;
+        });
+    }
+}
+
+static void registerSymmetry(string name, LazyMatrix cost)
+{
+    registerBenchmark("matrix/is_symmetric/" + name, [=](State &state) {
+        for (long long it = 0; it < state.iterations; ++it)
+            sink = isSymmetric(*cost);
+        state.items = (long long)cost->size() * cost->size();
+    });
+}
+
+static void registerCycles(int n)
+{
+    Lazy<vector<int>> succ([=]() {
+        mt19937 rng(n);
+        return randomCycleCover(n, 8, rng);
+    });
+    registerBenchmark("cycles/extract/" + to_string(n), [=](State &state) {
+        for (long long it = 0; it < state.iterations; ++it)
+            sink = cycles(*succ).size();
+        state.items = n;
+    });
+    // the same cycles seen as the edges of the undirected model
+    Lazy<vector<double>> edges([=]() {
+        vector<double> x((size_t)n * n, 0.0);
+        for (int i = 0; i < n; ++i)
+            x[(size_t)min(i, (*succ)[i]) * n + max(i, (*succ)[i])] = 1.0;
+        return x;
+    });
+    registerBenchmark("separation/undirected_components/" + to_string(n), [=](State &state) {
+        for (long long it = 0; it < state.iterations; ++it)
+            sink = edgeComponents(edges->data(), n).size();
+        state.items = (long long)n * n;
+    });
+}
+
+static void registerSubtour(string name, Lazy<Relaxations> relaxations)
+{
+    registerBenchmark("separation/subtour_mipsol/" + name, [=](State &state) {
+        const Relaxations &r = *relaxations;
+        for (long long it = 0; it < state.iterations; ++it)
+            sink = subtourFromSolution(r.integer.data(), r.n).size();
+        state.items = (long long)r.n * r.n;
+    });
+    registerBenchmark("separation/subtour_mipnode/" + name, [=](State &state) {
+        const Relaxations &r = *relaxations;
+        for (long long it = 0; it < state.iterations; ++it)
+            sink = subtourFromRelaxation(r.assignment.data(), r.n).size();
+        state.items = (long long)r.n * r.n;
+    });
+    // without time budget, to measure the whole search of the default length
+    registerBenchmark("separation/lifted_cycle/" + name, [=](State &state) {
+        const Relaxations &r = *relaxations;
+        for (long long it = 0; it < state.iterations; ++it)
+            sink = liftedCycleViolations(r.assignment.data(), r.n, 6, 1e9, 20).size();
+        state.items = (long long)r.n * r.n;
+    });
+}
+
+static void registerFlot(string name, Lazy<Relaxations> relaxations)
+{
+    registerBenchmark("separation/flot_linking/" + name, [=](State &state) {
+        const Relaxations &r = *relaxations;
+        for (long long it = 0; it < state.iterations; ++it)
+            sink = flotLinkingViolations(r.flot.data(), r.n).size();
+        state.items = (long long)r.n * r.n * r.n;
+    });
+}
+
+// the counters of the callbacks run at every event and every cut: they must stay
+// negligible next to the separation itself
+static void registerStats()
+{
+    registerBenchmark("stats/add_cut/16", [=](State &state) {
+        CutStats stats;
+        vector<int> support(16);
+        for (long long it = 0; it < state.iterations; ++it)
+        {
+            iota(support.begin(), support.end(), (int)(it % 4096)); // one in 4096 is new
+            stats.add(false, 0.25, support);
+        }
+        sink = stats.duplicates;
+    });
+    registerBenchmark("stats/trace_record", [=](State &state) {
+        Trace trace;
+        for (long long it = 0; it < state.iterations; ++it)
+            trace.record(it * 1e-3, 1000.0 - (it >> 10), 900.0, it);
+        sink = (long long)trace.primalDualIntegral();
+    });
+    // what the solver thread pays per incumbent streamed, the writer formatting
+    // and writing to /dev/null meanwhile
+    registerBenchmark("stats/incumbent_push/1000", [=](State &state) {
+        IncumbentStream stream("/dev/null");
+        mt19937 rng(1000);
+        vector<int> succ = tourToSuccessors(randomTour(1000, rng));
+        for (long long it = 0; it < state.iterations; ++it)
+        {
+            Incumbent incumbent = {it * 1e-3, 1e6 - it, 9e5, succ};
+            stream.push(std::move(incumbent));
+        }
+        sink = stream.dropped();
+    });
+}
+
+static void registerFixture(string path)
+{
+    // the first line tells the model, the rest is read by the first run
+    int n = 0, dims = 0;
+    ifstream file(path);
+    file >> n >> dims;
+    Lazy<Relaxations> relaxations([=]() {
+        Relaxations r;
+        int model;
+        vector<double> x = readRelaxation(path, r.n, model);
+        if (model == 3)
+            r.flot = x;
+        else
+        {
+            mt19937 rng(r.n);
+            r.integer = cycleCoverSolution(r.n, rng);
+            r.assignment = x;
+        }
+        return r;
+    });
+    if (dims == 3)
+        registerFlot("fixture_" + baseName(path), relaxations);
+    else
+        registerSubtour("fixture_" + baseName(path), relaxations);
+}
+
+static void registerAll(string dataDir, const vector<string> &fixtures)
+{
+    const char *instances[] = {"ftv33", "ftv70", "ftv170"};
+    for (const char *instance : instances)
+    {
+        string path = dataDir + "/" + instance + ".dat";
+        if (!fileExists(path))
+            continue;
+        registerParser(path);
+        LazyMatrix c([=]() {
+            streambuf *old = cout.rdbuf(nullptr);
+            vector<vector<int>> parsed = parse(path);
+            cout.rdbuf(old);
+            return parsed;
+        });
+        registerMatrix(instance, c);
+        registerHeuristics(instance, c);
+        if (string(instance) == "ftv170")
+        {
+            registerMultiStart(instance, c);
+            registerEax(instance, c);
+            registerKernels(instance, c);
+            registerBalas(instance, c, 10);
+        }
+
+        Lazy<Relaxations> relaxations([=]() {
+            Relaxations r;
+            r.n = c->size();
+            mt19937 rng(r.n);
+            r.integer = cycleCoverSolution(r.n, rng);
+            r.assignment = assignmentRelaxation(r.n, rng);
+            r.flot = flotRelaxation(r.n, rng);
+            return r;
+        });
+        registerSubtour(instance, relaxations);
+        registerFlot(instance, relaxations);
+    }
+    LazyMatrix random([]() { return randomMatrix(1000, 1000); });
+    LazyMatrix random5000([]() { return randomMatrix(5000, 5000); });
+    registerMatrix("random1000", random);
+    registerMultiStart("random300", LazyMatrix([]() { return randomMatrix(300, 300); }));
+    registerKernels("random5000", random5000);
+    registerRelabel("random2000", LazyMatrix([]() { return randomMatrix(2000, 2000); }));
+    registerBalas("random1000", random, 8);
+    registerBalas("random5000", random5000, 8);
+    registerSymmetry("symmetric1000", LazyMatrix([=]() {
+        vector<vector<int>> c = *random;
+        for (int i = 0; i < 1000; ++i)
+            for (int j = 0; j < i; ++j)
+                c[i][j] = c[j][i];
+        return c;
+    }));
+    registerCycles(170);
+    registerCycles(5000);
+    registerStats();
+    for (const string &fixture : fixtures)
+        registerFixture(fixture);
+}
+
+// --- checks (--check) ---
+
+// positions of a reordering of order (order[0] staying first) allowed by the
+// Balas-Simonetti neighbourhood: the one at i before the one at j if j >= i + k
+static bool inNeighbourhood(const vector<int> &positions, int k)
+{
+    for (size_t p = 0; p < positions.size(); ++p)
+        for (size_t q = p + 1; q < positions.size(); ++q)
+            if (positions[p] >= positions[q] + k)
+                return false;
+    return true;
+}
+
+// the dynamic program of balas.hpp against the enumeration of its neighbourhood
+// on 300 random instances of 4 to 9 cities, k = 2..6
+static bool checkBalas()
+{
+    mt19937 rng(50);
+    int failures = 0;
+    for (int instance = 0; instance < 300; ++instance)
+    {
+        int n = 4 + instance % 6, k = 2 + instance / 6 % 5;
+        vector<vector<int>> c = randomMatrix(n, rng());
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                c[i][j] = i == j ? 0 : c[i][j] % 20; // ties
+        vector<int> succ = tourToSuccessors(randomTour(n, rng));
+        int start = rng() % n;
+        vector<int> order = successorsToTour(succ, start);
+
+        vector<int> positions(n - 1);
+        iota(positions.begin(), positions.end(), 1);
+        long long best = tourCost(c, order);
+        do
+        {
+            if (!inNeighbourhood(positions, k))
+                continue;
+            vector<int> tour(1, order[0]);
+            for (int p : positions)
+                tour.push_back(order[p]);
+            best = min(best, tourCost(c, tour));
+        } while (next_permutation(positions.begin(), positions.end()));
+
+        bool improved = balasSimonetti(c, succ, BalasSimonettiTable(k), start);
+        vector<int> tour = successorsToTour(succ, start);
+        vector<int> position(n);
+        for (int p = 0; p < n; ++p)
+            position[order[p]] = p;
+        vector<int> found;
+        for (int p = 1; p < n; ++p)
+            found.push_back(position[tour[p]]);
+        if ((int)tour.size() != n || !inNeighbourhood(found, k) || tourCost(c, tour) != best || improved != (best < tourCost(c, order)))
+        {
+            cerr << "balas: n = " << n << ", k = " << k << ": " << tourCost(c, tour) << " instead of " << best << endl;
+            failures++;
+        }
+    }
+    cout << "balas: 300 instances, " << failures << " failures" << endl;
+    return failures == 0;
+}
+
+// every level of the kernels of kernels.hpp against the references on the
+// vector<vector<int>> matrix, ties included, on random matrices of 1 to 1001
+// cities (around the vector widths and the batch size of 64 below 200)
+static bool checkKernels()
+{
+    mt19937 rng(43);
+    int failures = 0, matrices = 0;
+    for (int n = 1; n <= 1001; n += n < 200 ? 1 : 50)
+    {
+        matrices++;
+        vector<vector<int>> c = randomMatrix(n, n);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                c[i][j] = i == j ? 0 : c[i][j] % 8; // ties
+        CostMatrix matrix(c);
+        vector<int> tour = randomTour(n, rng);
+        vector<int> cities(tour.begin(), tour.begin() + min(n, 1 + (int)(rng() % 100)));
+        int first = tour[0], last = tour[n / 2];
+
+        long long cost = tourCost(c, tour);
+        vector<int> delta(n), successors(cities.size()), predecessors(cities.size());
+        for (int k = 0; k < n; ++k)
+        {
+            int a = tour[k], b = tour[(k + 1) % n];
+            delta[k] = c[a][first] + c[last][b] - c[a][b];
+        }
+        for (size_t k = 0; k < cities.size(); ++k)
+        {
+            int i = cities[k];
+            successors[k] = predecessors[k] = -1;
+            for (int j = n - 1; j >= 0; --j) // the smallest j on ties
+            {
+                if (j == i)
+                    continue;
+                if (successors[k] < 0 || c[i][j] <= c[i][successors[k]])
+                    successors[k] = j;
+                if (predecessors[k] < 0 || c[j][i] <= c[predecessors[k]][i])
+                    predecessors[k] = j;
+            }
+        }
+
+        for (int level = ScalarKernels; level <= supportedKernels(); ++level)
+        {
+            setKernels((KernelLevel)level);
+            vector<int> d, s, p;
+            insertionDeltas(matrix, tour, first, last, d);
+            bestSuccessors(matrix, cities, s);
+            bestPredecessors(matrix, cities, p);
+            if (tourCostBatch(matrix, tour) != cost || d != delta || s != successors || p != predecessors)
+            {
+                cerr << "kernels: " << kernelName((KernelLevel)level) << " differs on " << n << " cities" << endl;
+                failures++;
+            }
+        }
+    }
+    setKernels(supportedKernels());
+    cout << "kernels: " << matrices << " matrices up to " << kernelName(supportedKernels()) << ", " << failures << " failures" << endl;
+    return failures == 0;
+}
+
+static void writeJson(ostream &out, const vector<Measure> &measures, string executable)
+{
+    time_t now = time(nullptr);
+    char date[64];
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    out << "{\n";
+    out << "  \"context\": {\n";
+    out << "    \"date\": \"" << date << "\",\n";
+    out << "    \"executable\": \"" << executable << "\",\n";
+    out << "    \"num_cpus\": " << thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+    out << "    \"library_build_type\": \"release\"\n";
+#else
+    out << "    \"library_build_type\": \"debug\"\n";
+#endif
+    out << "  },\n";
+    out << "  \"benchmarks\": [\n";
+    for (size_t b = 0; b < measures.size(); ++b)
+    {
+        const Measure &m = measures[b];
+        out << "    {\n";
+        out << "      \"name\": \"" << m.name << "\",\n";
+        out << "      \"run_name\": \"" << m.name << "\",\n";
+        out << "      \"run_type\": \"iteration\",\n";
+        out << "      \"iterations\": " << m.iterations << ",\n";
+        out << "      \"real_time\": " << m.realTime << ",\n";
+        out << "      \"cpu_time\": " << m.cpuTime << ",\n";
+        out << "      \"time_unit\": \"ns\"";
+        if (m.items > 0)
+            out << ",\n      \"items_per_second\": " << m.items * 1e9 / m.realTime;
+        if (m.bytes > 0)
+            out << ",\n      \"bytes_per_second\": " << m.bytes * 1e9 / m.realTime;
+        out << "\n    }" << (b + 1 < measures.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+static bool option(const char *arg, const char *name, string &value)
+{
+    size_t length = strlen(name);
+    if (strncmp(arg, name, length) != 0 || arg[length] != '=')
+        return false;
+    value = arg + length + 1;
+    return true;
+}
+
+int main(int argc,
+         char *argv[])
+{
+    string dataDir = "TSP_data";
+    string filter = ".*";
+    string out;
+    double minTime = 0.2;
+    vector<string> fixtures;
+    for (int a = 1; a < argc; ++a)
+    {
+        string value;
+        if (option(argv[a], "--data", value))
+            dataDir = value;
+        else if (option(argv[a], "--fixture", value))
+            fixtures.push_back(value);
+        else if (option(argv[a], "--benchmark_filter", value))
+            filter = value;
+        else if (option(argv[a], "--benchmark_min_time", value))
+            minTime = atof(value.c_str());
+        else if (option(argv[a], "--benchmark_out", value))
+            out = value;
+        else if (strcmp(argv[a], "--check") == 0)
+        {
+            bool passed = checkBalas();
+            passed = checkKernels() && passed;
+            return passed ? 0 : 1;
+        }
+        else
+        {
+            cerr << "Unknown option " << argv[a] << endl;
+            return 1;
+        }
+    }
+
+    registerAll(dataDir, fixtures);
+
+    regex selected(filter);
+    vector<Measure> measures;
+    printf("%-48s %15s %15s %12s\n", "Benchmark", "Time (ns)", "CPU (ns)", "Iterations");
+    for (const Benchmark &b : benchmarks)
+    {
+        if (!regex_search(b.name, selected))
+            continue;
+        Measure m = measure(b, minTime);
+        printf("%-48s %15.0f %15.0f %12lld\n", m.name.c_str(), m.realTime, m.cpuTime, m.iterations);
+        measures.push_back(m);
+    }
+
+    if (!out.empty())
+    {
+        ofstream file(out);
+        writeJson(file, measures, argv[0]);
+    }
+    return 0;
+}
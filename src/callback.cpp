@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include "callback.hpp"
+#include "heuristic.hpp"
+#include "parser.hpp"
+#include "tour.hpp"
+
+ArcVariables::ArcVariables(const Graph *_g, bool _symmetric)
+{
+    g = _g;
+    symmetric = _symmetric;
+}
+
+ArcVariables::ArcVariables(const Graph *_g, const GRBVar *x, bool _symmetric)
+{
+    g = _g;
+    symmetric = _symmetric;
+    for (int a = 0; a < g->m; ++a)
+        add(x[a], a);
+}
+
+void ArcVariables::add(GRBVar var, int arc)
+{
+    vars.push_back(var);
+    arcOf.push_back(arc);
+}
+
+ModelCallback::ModelCallback()
+{
+    bestObjective = GRB_INFINITY;
+    streamedCount = 0;
+    lastStopCheck = -1;
+    checkpointEvery = 60;
+    lastCheckpoint = 0;
+    patchBudget = 0;
+}
+
+void ModelCallback::watch(const Config &config, const ArcVariables &_arcs, unsigned long long instance)
+{
+    arcs.reset(new ArcVariables(_arcs));
+    previous.instance = instance;
+    stopFile = config.get("stop-file");
+    checkpointFile = config.get("checkpoint");
+    checkpointEvery = config.number("checkpoint-every", 60);
+    if (config.has("relabel-map"))
+    {
+        std::string mapPath = config.get("relabel-map");
+        if (!readRelabelling(mapPath, relabelling) || (int)relabelling.original.size() != arcs->g->n)
+        {
+            std::cerr << "Relabel map read failed: " << mapPath << std::endl;
+            exit(-1);
+        }
+    }
+    if (config.has("patching"))
+    {
+        const Graph &g = *arcs->g;
+        patchBudget = config.number("patching-budget", 0.05);
+        patchCosts.assign(g.n, std::vector<int>(g.n, forbiddenCost));
+        for (int a = 0; a < g.m; ++a)
+        {
+            patchCosts[g.tail[a]][g.head[a]] = g.cost[a];
+            if (arcs->symmetric)
+                patchCosts[g.head[a]][g.tail[a]] = g.cost[a];
+        }
+    }
+    std::string filePath = config.get("incumbents");
+    if (filePath.empty())
+        return;
+    stream.reset(new IncumbentStream(filePath));
+    if (!stream->ok())
+    {
+        std::cerr << "Incumbent stream open failed: " << filePath << std::endl;
+        stream.reset();
+    }
+}
+
+void ModelCallback::closeStream()
+{
+    stream.reset();
+}
+
+long ModelCallback::streamed() const
+{
+    return streamedCount;
+}
+
+void ModelCallback::resume(const Checkpoint &_previous)
+{
+    previous = _previous;
+    if (!previous.succ.empty())
+    {
+        bestTour = previous.succ;
+        bestObjective = previous.objective;
+    }
+}
+
+double ModelCallback::totalRuntime(double runtime) const
+{
+    return previous.runtime + runtime;
+}
+
+void ModelCallback::saveCheckpoint(double bound, double runtime)
+{
+    if (checkpointFile.empty() || !arcs)
+        return;
+    Checkpoint checkpoint = previous;
+    checkpoint.n = arcs->g->n;
+    if (!bestTour.empty())
+    {
+        checkpoint.succ = bestTour;
+        checkpoint.objective = bestObjective;
+    }
+    // a bound of this run may be weaker than the one of the run it resumes
+    checkpoint.bound = std::max(checkpoint.bound, bound);
+    checkpoint.runtime = totalRuntime(runtime);
+    saveCuts(checkpoint);
+    if (!writeCheckpoint(checkpointFile, checkpoint))
+        std::cerr << "Checkpoint write failed: " << checkpointFile << std::endl;
+    lastCheckpoint = runtime;
+}
+
+// the solution of the MIPSOL event, if it is a tour better than the best one
+// seen: only the successors are extracted here, the writer of the stream formats them
+void ModelCallback::recordIncumbent()
+{
+    double objective = getDoubleInfo(GRB_CB_MIPSOL_OBJ);
+    if (objective >= bestObjective - 1e-6)
+        return;
+    const Graph &g = *arcs->g;
+    std::vector<double> value(g.m, 0.0);
+    double *val = getSolution(arcs->vars.data(), arcs->vars.size());
+    for (size_t v = 0; v < arcs->vars.size(); ++v)
+        value[arcs->arcOf[v]] += val[v];
+    delete[] val;
+
+    // solutions with subtours are cut off by the lazy constraints
+    Incumbent incumbent;
+    incumbent.succ = arcSuccessors(g, value, arcs->symmetric);
+    for (int j : incumbent.succ)
+    {
+        if (j < 0)
+            return;
+    }
+    incumbent.time = getDoubleInfo(GRB_CB_RUNTIME);
+    incumbent.objective = objective;
+    incumbent.bound = getDoubleInfo(GRB_CB_MIPSOL_OBJBND);
+    bestObjective = objective;
+    bestTour = incumbent.succ;
+    if (stream)
+    {
+        streamedCount++;
+        if (!relabelling.original.empty())
+            incumbent.succ = originalSuccessors(incumbent.succ, relabelling);
+        stream->push(std::move(incumbent));
+    }
+}
+
+// the heuristic runs while it has taken less than its share of the solver time
+// (of at least one second), on the optimal node relaxations only
+void ModelCallback::patchNode()
+{
+    if (stats.patchTime > patchBudget * std::max(getDoubleInfo(GRB_CB_RUNTIME), 1.0) || getIntInfo(GRB_CB_MIPNODE_STATUS) != GRB_OPTIMAL)
+        return;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const Graph &g = *arcs->g;
+    int n = g.n;
+    std::vector<double> x((size_t)n * n, 0.0);
+    double *val = getNodeRel(arcs->vars.data(), arcs->vars.size());
+    for (size_t v = 0; v < arcs->vars.size(); ++v)
+    {
+        int a = arcs->arcOf[v];
+        x[(size_t)g.tail[a] * n + g.head[a]] += val[v];
+        if (arcs->symmetric)
+            x[(size_t)g.head[a] * n + g.tail[a]] += val[v];
+    }
+    delete[] val;
+
+    std::vector<int> succ = patchRelaxation(patchCosts, x);
+    if (!succ.empty() && succ != lastPatched)
+    {
+        lastPatched = succ;
+        stats.patched++;
+        if (successorCost(patchCosts, succ) < getDoubleInfo(GRB_CB_MIPNODE_OBJBST) - 0.5)
+        {
+            std::vector<char> onTour(g.m, 0);
+            for (int i = 0; i < n; ++i)
+                onTour[arcs->symmetric ? g.arc(std::min(i, succ[i]), std::max(i, succ[i])) : g.arc(i, succ[i])] = 1;
+            // one variable per arc, or the flow variables of the arcs off the tour only
+            bool single = arcs->vars.size() == (size_t)g.m;
+            std::vector<GRBVar> vars;
+            std::vector<double> values;
+            for (size_t v = 0; v < arcs->vars.size(); ++v)
+            {
+                if (!onTour[arcs->arcOf[v]] || single)
+                {
+                    vars.push_back(arcs->vars[v]);
+                    values.push_back(onTour[arcs->arcOf[v]]);
+                }
+            }
+            setSolution(vars.data(), values.data(), vars.size());
+            stats.injected++;
+        }
+    }
+    stats.patchTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// the file system is looked at most every 0.2 second
+void ModelCallback::checkStop()
+{
+    double now = getDoubleInfo(GRB_CB_RUNTIME);
+    if (lastStopCheck >= 0 && now - lastStopCheck < 0.2)
+        return;
+    lastStopCheck = now;
+    if (std::ifstream(stopFile).good())
+        abort();
+}
+
+void ModelCallback::callback()
+{
+    stats.call(where);
+    try
+    {
+        if (where == GRB_CB_MIP)
+            trace.record(getDoubleInfo(GRB_CB_RUNTIME), getDoubleInfo(GRB_CB_MIP_OBJBST), getDoubleInfo(GRB_CB_MIP_OBJBND), getDoubleInfo(GRB_CB_MIP_NODCNT));
+        else if (where == GRB_CB_MIPSOL)
+            trace.record(getDoubleInfo(GRB_CB_RUNTIME), getDoubleInfo(GRB_CB_MIPSOL_OBJBST), getDoubleInfo(GRB_CB_MIPSOL_OBJBND), getDoubleInfo(GRB_CB_MIPSOL_NODCNT));
+        if (where == GRB_CB_MIPSOL && (stream || !checkpointFile.empty()))
+            recordIncumbent();
+        if (where == GRB_CB_MIP && !checkpointFile.empty() && getDoubleInfo(GRB_CB_RUNTIME) - lastCheckpoint >= checkpointEvery)
+            saveCheckpoint(getDoubleInfo(GRB_CB_MIP_OBJBND), getDoubleInfo(GRB_CB_RUNTIME));
+        if (where == GRB_CB_MIPNODE && !patchCosts.empty())
+            patchNode();
+        if (!stopFile.empty() && (where == GRB_CB_MIP || where == GRB_CB_MIPSOL || where == GRB_CB_MIPNODE))
+            checkStop();
+    }
+    catch (GRBException e)
+    {
+        std::cerr << "Error number: " << e.getErrorCode() << std::endl;
+        std::cerr << e.getMessage() << std::endl;
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    separate();
+    stats.separationTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ModelCallback::addCut(const GRBTempConstr &constr, double violation, const std::vector<int> &support)
+{
+    GRBCallback::addCut(constr);
+    stats.add(false, violation, support);
+}
+
+void ModelCallback::addLazy(const GRBTempConstr &constr, double violation, const std::vector<int> &support)
+{
+    GRBCallback::addLazy(constr);
+    stats.add(true, violation, support);
+}
+
+void finishCallback(GRBModel &model, ModelCallback &cb, const Config &config)
+{
+    bool solved = model.get(GRB_IntAttr_SolCount) > 0;
+    cb.trace.finish(model.get(GRB_DoubleAttr_Runtime),
+                    solved ? model.get(GRB_DoubleAttr_ObjVal) : GRB_INFINITY,
+                    model.get(GRB_DoubleAttr_ObjBound),
+                    model.get(GRB_DoubleAttr_NodeCount));
+    cb.closeStream();
+    cb.saveCheckpoint(model.get(GRB_DoubleAttr_ObjBound), model.get(GRB_DoubleAttr_Runtime));
+    if (config.verbose)
+        cb.stats.print(std::cout);
+    std::string filePath = config.get("trace");
+    if (filePath.empty())
+        return;
+    if (!cb.trace.writeCsv(filePath))
+        std::cerr << "Trace write failed: " << filePath << std::endl;
+    else if (config.verbose)
+        std::cout << "--> Progress trace written to " << filePath << std::endl;
+}
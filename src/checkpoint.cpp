@@ -0,0 +1,115 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include "checkpoint.hpp"
+#include "cutlib.hpp"
+
+Checkpoint::Checkpoint()
+{
+    n = 0;
+    instance = 0;
+    objective = std::numeric_limits<double>::infinity();
+    bound = -std::numeric_limits<double>::infinity();
+    runtime = 0;
+}
+
+bool readCheckpoint(std::string filePath, const std::vector<std::vector<int>> &c, Checkpoint &checkpoint)
+{
+    int n = c.size();
+    std::ifstream file(filePath);
+    if (!file.is_open())
+        return false;
+    checkpoint = Checkpoint();
+    std::string line, key;
+    while (getline(file, line))
+    {
+        std::istringstream fields(line);
+        if (!(fields >> key))
+            continue;
+        if (key == "n")
+            fields >> checkpoint.n;
+        else if (key == "instance")
+            fields >> std::hex >> checkpoint.instance;
+        else if (key == "tour")
+        {
+            checkpoint.succ.assign(n, -1);
+            for (int i = 0; i < n; ++i)
+                fields >> checkpoint.succ[i];
+        }
+        else if (key == "objective")
+            fields >> checkpoint.objective;
+        else if (key == "bound")
+            fields >> checkpoint.bound;
+        else if (key == "runtime")
+            fields >> checkpoint.runtime;
+        else if (key == "cut")
+        {
+            int k = 0;
+            fields >> k;
+            std::vector<int> S(k);
+            for (int &v : S)
+                fields >> v;
+            checkpoint.subtours.push_back(S);
+        }
+        else if (key == "link")
+        {
+            std::vector<int> link(3);
+            fields >> link[0] >> link[1] >> link[2];
+            checkpoint.links.push_back(link);
+        }
+    }
+    if (checkpoint.n != n)
+    {
+        std::cerr << "Checkpoint of another instance: " << filePath << " (" << checkpoint.n << " cities instead of " << n << ")" << std::endl;
+        exit(-1);
+    }
+    // a bound or a tour of another instance of the same size could cut off the optimum
+    if (checkpoint.instance != instanceHash(c))
+    {
+        std::cerr << "Checkpoint of another instance: " << filePath << " (instance hash " << std::hex << checkpoint.instance
+                  << " instead of " << instanceHash(c) << std::dec << ")" << std::endl;
+        exit(-1);
+    }
+    return true;
+}
+
+bool writeCheckpoint(std::string filePath, const Checkpoint &checkpoint)
+{
+    std::string temporary = filePath + ".tmp";
+    {
+        std::ofstream file(temporary);
+        if (!file.is_open())
+            return false;
+        file.precision(17);
+        file << "n " << checkpoint.n << std::endl;
+        if (checkpoint.instance != 0)
+            file << "instance " << std::hex << checkpoint.instance << std::dec << std::endl;
+        if (!checkpoint.succ.empty())
+        {
+            file << "tour";
+            for (int j : checkpoint.succ)
+                file << " " << j;
+            file << std::endl;
+            file << "objective " << checkpoint.objective << std::endl;
+        }
+        if (std::isfinite(checkpoint.bound))
+            file << "bound " << checkpoint.bound << std::endl;
+        file << "runtime " << checkpoint.runtime << std::endl;
+        for (const std::vector<int> &S : checkpoint.subtours)
+        {
+            file << "cut " << S.size();
+            for (int v : S)
+                file << " " << v;
+            file << std::endl;
+        }
+        for (const std::vector<int> &link : checkpoint.links)
+            file << "link " << link[0] << " " << link[1] << " " << link[2] << std::endl;
+        if (!file.good())
+            return false;
+    }
+    return rename(temporary.c_str(), filePath.c_str()) == 0;
+}
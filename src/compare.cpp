@@ -0,0 +1,175 @@
+#include "results.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+using namespace std;
+
+// Compares the Result lines of a new campaign with a reference one (e.g. sol_mtz).
+// Each instance may have been run several times (see benchmark.sh): the median
+// runtime is compared, and every run must reach the best reference objective.
+// A run proved its objective optimal when its status field says so; for the
+// Result lines without a status (heuristics, older logs), when it ended before
+// --time-limit.
+//
+// usage : ./compare.out <BASELINE> <CANDIDATE> [--tolerance=0.10] [--slack=0.5] [--time-limit=600]
+//
+// BASELINE and CANDIDATE are results.csv files, runner logs or solution directories.
+// When both campaigns report a primal-dual integral (see trace.hpp), their sums
+// are printed too, to rank the formulations by anytime performance.
+// The exit code is 0 when everything passes, 1 on a correctness failure (objective
+// mismatch) and 2 on a performance failure only.
+
+struct Runs
+{
+    vector<double> runtimes;
+    vector<double> objectives;
+    vector<double> integrals; ///< primal-dual integrals, when the model reports them
+    vector<char> limited;     ///< per run, stopped before proving optimality
+};
+
+static double median(vector<double> values)
+{
+    sort(values.begin(), values.end());
+    size_t m = values.size() / 2;
+    return values.size() % 2 ? values[m] : (values[m - 1] + values[m]) / 2;
+}
+
+static bool sameValue(double a, double b)
+{
+    return fabs(a - b) <= 1e-6 * max(1.0, max(fabs(a), fabs(b)));
+}
+
+static map<string, Runs> group(const vector<RunResult> &results, double timeLimit)
+{
+    map<string, Runs> runs;
+    for (const RunResult &r : results)
+    {
+        map<string, string>::const_iterator status = r.fields.find("status");
+        runs[r.instance].limited.push_back(status != r.fields.end() ? status->second != "optimal" : r.runtime >= 0.99 * timeLimit);
+        runs[r.instance].runtimes.push_back(r.runtime);
+        runs[r.instance].objectives.push_back(r.objective);
+        map<string, string>::const_iterator integral = r.fields.find("primal-dual integral");
+        if (integral != r.fields.end())
+            runs[r.instance].integrals.push_back(atof(integral->second.c_str()));
+    }
+    return runs;
+}
+
+static bool option(const char *arg, const char *name, double &value)
+{
+    size_t length = strlen(name);
+    if (strncmp(arg, name, length) != 0 || arg[length] != '=')
+        return false;
+    value = atof(arg + length + 1);
+    return true;
+}
+
+int main(int argc,
+         char *argv[])
+{
+    double tolerance = 0.10; ///< relative runtime increase accepted
+    double slack = 0.5;      ///< absolute runtime increase (in seconds) accepted, against timer noise
+    double timeLimit = 600.0;
+    vector<string> paths;
+    for (int a = 1; a < argc; ++a)
+    {
+        if (option(argv[a], "--tolerance", tolerance) || option(argv[a], "--slack", slack) || option(argv[a], "--time-limit", timeLimit))
+            continue;
+        if (argv[a][0] == '-')
+        {
+            cerr << "Unknown option " << argv[a] << endl;
+            return 1;
+        }
+        paths.push_back(argv[a]);
+    }
+    if (paths.size() != 2)
+    {
+        cerr << "usage : " << argv[0] << " <BASELINE> <CANDIDATE> [--tolerance=0.10] [--slack=0.5] [--time-limit=600]" << endl;
+        return 1;
+    }
+
+    map<string, Runs> baseline = group(readResults(paths[0]), timeLimit);
+    map<string, Runs> candidate = group(readResults(paths[1]), timeLimit);
+
+    int correctness = 0, performance = 0, compared = 0;
+    double logSpeedups = 0;
+    // anytime performance: sums of the median primal-dual integrals, on the
+    // instances where both campaigns report it (lower is better)
+    double baseIntegral = 0, newIntegral = 0;
+    int integrals = 0;
+    printf("%-12s %5s %12s %12s %9s %12s %12s  %s\n", "instance", "runs", "base (s)", "new (s)", "speedup", "base obj", "new obj", "status");
+    for (map<string, Runs>::const_iterator it = candidate.begin(); it != candidate.end(); ++it)
+    {
+        const string &instance = it->first;
+        const Runs &runs = it->second;
+        if (!baseline.count(instance))
+        {
+            printf("%-12s %5zu %12s %12.3f %9s %12s %12g  no baseline\n", instance.c_str(), runs.runtimes.size(), "-", median(runs.runtimes), "-", "-", runs.objectives[0]);
+            continue;
+        }
+        const Runs &base = baseline[instance];
+        double baseTime = median(base.runtimes);
+        double newTime = median(runs.runtimes);
+        // runs stopped by the time limit only give a feasible solution, not the
+        // optimum: the best baseline objective is the optimum if any run proved it
+        double baseObj = *min_element(base.objectives.begin(), base.objectives.end());
+        double newObj = *min_element(runs.objectives.begin(), runs.objectives.end());
+        bool baseLimited = find(base.limited.begin(), base.limited.end(), 0) == base.limited.end();
+        bool allLimited = find(runs.limited.begin(), runs.limited.end(), 0) == runs.limited.end();
+
+        string status = "ok";
+        for (size_t r = 0; r < runs.objectives.size(); ++r)
+        {
+            double obj = runs.objectives[r];
+            bool newLimited = runs.limited[r];
+            bool wrong;
+            if (!baseLimited && !newLimited)
+                wrong = !sameValue(obj, baseObj);
+            else if (!newLimited)
+                wrong = obj > baseObj && !sameValue(obj, baseObj); // a proven optimum cannot be worse
+            else
+                wrong = !baseLimited && obj < baseObj && !sameValue(obj, baseObj); // nor better than a proven optimum
+            if (wrong)
+                status = "OBJECTIVE MISMATCH";
+        }
+        if (status != "ok")
+            correctness++;
+        else if (newTime > baseTime * (1 + tolerance) + slack)
+        {
+            status = "SLOWER";
+            performance++;
+        }
+        else if (allLimited && baseLimited)
+            status = newObj < baseObj ? "ok (time limit, better)" : newObj > baseObj ? "ok (time limit, worse)" : "ok (time limit)";
+
+        if (!base.integrals.empty() && !runs.integrals.empty())
+        {
+            baseIntegral += median(base.integrals);
+            newIntegral += median(runs.integrals);
+            integrals++;
+        }
+
+        double speedup = newTime > 0 ? baseTime / newTime : 0;
+        if (speedup > 0)
+        {
+            logSpeedups += log(speedup);
+            compared++;
+        }
+        printf("%-12s %5zu %12.3f %12.3f %8.2fx %12g %12g  %s\n", instance.c_str(), runs.runtimes.size(), baseTime, newTime, speedup, baseObj, newObj, status.c_str());
+    }
+
+    if (compared > 0)
+        printf("geometric mean speedup: %.2fx over %d instances\n", exp(logSpeedups / compared), compared);
+    if (integrals > 0)
+        printf("primal-dual integral: %.3f -> %.3f over %d instances\n", baseIntegral, newIntegral, integrals);
+    printf("correctness failures: %d, performance failures: %d\n", correctness, performance);
+
+    if (correctness > 0)
+        return 1;
+    if (performance > 0)
+        return 2;
+    return 0;
+}
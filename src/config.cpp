@@ -0,0 +1,111 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include "config.hpp"
+
+static std::string trim(std::string s)
+{
+    size_t first = s.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos)
+        return "";
+    size_t last = s.find_last_not_of(" \t\r\n");
+    return s.substr(first, last - first + 1);
+}
+
+static void set(Config &config, std::string key, std::string value)
+{
+    if (key == "time-limit")
+        config.timeLimit = atof(value.c_str());
+    else if (key == "threads")
+        config.threads = atoi(value.c_str());
+    else if (key.compare(0, 6, "param.") == 0)
+        config.params[key.substr(6)] = value;
+    else
+        config.options[key] = value;
+}
+
+static void readConfigFile(Config &config, std::string filePath)
+{
+    std::ifstream file(filePath);
+    if (!file.is_open())
+    {
+        std::cerr << "Config file open failed: " << filePath << std::endl;
+        exit(-1);
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty())
+            continue;
+        size_t equal = line.find('=');
+        if (equal == std::string::npos)
+            set(config, line, "");
+        else
+            set(config, trim(line.substr(0, equal)), trim(line.substr(equal + 1)));
+    }
+}
+
+Config parseArgs(int argc, char *argv[], double defaultTimeLimit)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage : " << argv[0] << " <PATH_TO_DAT_FILE> [-nv] [--config=<file>] [--<key>=<value>]..." << std::endl;
+        exit(-1);
+    }
+    Config config;
+    config.instance = argv[1];
+    config.verbose = true;
+    config.timeLimit = defaultTimeLimit;
+    config.threads = std::thread::hardware_concurrency();
+    if (config.threads <= 0)
+        config.threads = 1;
+
+    // the file first, so that the command line overrides it
+    for (int a = 2; a < argc; ++a)
+    {
+        if (strncmp(argv[a], "--config=", 9) == 0)
+            readConfigFile(config, argv[a] + 9);
+    }
+    for (int a = 2; a < argc; ++a)
+    {
+        std::string arg = argv[a];
+        if (arg == "-nv")
+            config.verbose = false;
+        else if (arg.compare(0, 9, "--config=") == 0)
+            continue;
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            size_t equal = arg.find('=');
+            if (equal == std::string::npos)
+                set(config, arg.substr(2), "");
+            else
+                set(config, arg.substr(2, equal - 2), arg.substr(equal + 1));
+        }
+        else
+        {
+            std::cerr << "Unknown argument " << arg << std::endl;
+            exit(-1);
+        }
+    }
+    return config;
+}
+
+bool Config::has(std::string key) const
+{
+    return options.count(key) > 0;
+}
+
+std::string Config::get(std::string key, std::string otherwise) const
+{
+    std::map<std::string, std::string>::const_iterator it = options.find(key);
+    return it == options.end() ? otherwise : it->second;
+}
+
+double Config::number(std::string key, double otherwise) const
+{
+    std::map<std::string, std::string>::const_iterator it = options.find(key);
+    return it == options.end() || it->second.empty() ? otherwise : atof(it->second.c_str());
+}
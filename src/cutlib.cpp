@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <sys/stat.h>
+#include "cutlib.hpp"
+
+unsigned long long instanceHash(const std::vector<std::vector<int>> &c)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    std::vector<long long> values(1, (long long)c.size());
+    for (const std::vector<int> &row : c)
+        values.insert(values.end(), row.begin(), row.end());
+    for (long long value : values)
+    {
+        for (int byte = 0; byte < 8; ++byte)
+        {
+            hash ^= (unsigned long long)(value >> (8 * byte)) & 0xff;
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+CutLibrary loadCutLibrary(std::string directory, const std::vector<std::vector<int>> &c)
+{
+    CutLibrary library;
+    std::stringstream ss;
+    ss << directory << "/" << std::hex << instanceHash(c) << ".cuts";
+    library.path = ss.str();
+    library.n = c.size();
+    library.runs = 0;
+    mkdir(directory.c_str(), 0755);
+
+    std::ifstream file(library.path);
+    std::string line, key;
+    int n = -1;
+    while (getline(file, line))
+    {
+        std::istringstream fields(line);
+        if (!(fields >> key))
+            continue;
+        if (key == "n")
+            fields >> n;
+        else if (key == "runs")
+            fields >> library.runs;
+        else if (key == "cut")
+        {
+            LibraryCut cut;
+            int k = 0;
+            fields >> cut.score >> cut.lastRun >> k;
+            cut.S.resize(k);
+            for (int &v : cut.S)
+                fields >> v;
+            library.cuts.push_back(cut);
+        }
+    }
+    // a hash collision: the file is another instance's, which this one replaces
+    if (n != library.n)
+    {
+        library.runs = 0;
+        library.cuts.clear();
+    }
+    return library;
+}
+
+bool saveCutLibrary(const CutLibrary &library)
+{
+    std::string temporary = library.path + ".tmp";
+    {
+        std::ofstream file(temporary);
+        if (!file.is_open())
+            return false;
+        file << "n " << library.n << std::endl;
+        file << "runs " << library.runs << std::endl;
+        for (const LibraryCut &cut : library.cuts)
+        {
+            file << "cut " << cut.score << " " << cut.lastRun << " " << cut.S.size();
+            for (int v : cut.S)
+                file << " " << v;
+            file << std::endl;
+        }
+        if (!file.good())
+            return false;
+    }
+    return rename(temporary.c_str(), library.path.c_str()) == 0;
+}
+
+static bool stronger(const LibraryCut &a, const LibraryCut &b)
+{
+    if (a.score != b.score)
+        return a.score > b.score;
+    return a.S.size() < b.S.size();
+}
+
+std::vector<std::vector<int>> seedCuts(const CutLibrary &library, int count)
+{
+    std::vector<LibraryCut> sorted = library.cuts;
+    std::stable_sort(sorted.begin(), sorted.end(), stronger);
+    std::vector<std::vector<int>> seeds;
+    for (int k = 0; k < count && k < (int)sorted.size(); ++k)
+        seeds.push_back(sorted[k].S);
+    return seeds;
+}
+
+void recordRun(CutLibrary &library, const std::vector<std::vector<int>> &found, const std::vector<std::vector<int>> &seeds,
+               const std::vector<int> &succ, size_t capacity)
+{
+    int run = ++library.runs;
+    std::map<std::vector<int>, size_t> index;
+    for (size_t k = 0; k < library.cuts.size(); ++k)
+    {
+        library.cuts[k].score /= 2;
+        index[library.cuts[k].S] = k;
+    }
+
+    std::vector<std::vector<int>> binding;
+    for (std::vector<int> S : found)
+    {
+        sort(S.begin(), S.end());
+        binding.push_back(S);
+    }
+    // a seeded cut is tight when the tour enters S once: |S| - 1 of its arcs are inside
+    if (!succ.empty())
+    {
+        std::vector<char> inS(library.n, 0);
+        for (std::vector<int> S : seeds)
+        {
+            for (int v : S)
+                inS[v] = 1;
+            int inside = 0;
+            for (int v : S)
+                inside += succ[v] >= 0 && inS[succ[v]];
+            for (int v : S)
+                inS[v] = 0;
+            if (inside == (int)S.size() - 1)
+            {
+                sort(S.begin(), S.end());
+                binding.push_back(S);
+            }
+        }
+    }
+
+    for (const std::vector<int> &S : binding)
+    {
+        std::map<std::vector<int>, size_t>::iterator it = index.find(S);
+        if (it == index.end())
+        {
+            LibraryCut cut;
+            cut.S = S;
+            cut.score = 0;
+            cut.lastRun = 0;
+            it = index.insert(std::make_pair(S, library.cuts.size())).first;
+            library.cuts.push_back(cut);
+        }
+        LibraryCut &cut = library.cuts[it->second];
+        // a cut found twice in a run counts once
+        if (cut.lastRun != run)
+            cut.score += 1;
+        cut.lastRun = run;
+    }
+
+    if (library.cuts.size() > capacity)
+    {
+        std::stable_sort(library.cuts.begin(), library.cuts.end(), stronger);
+        library.cuts.resize(capacity);
+    }
+}
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include "cutstats.hpp"
+
+// FNV-1a over the sorted support, so that the order of the items does not matter
+static uint64_t supportKey(std::vector<int> support)
+{
+    std::sort(support.begin(), support.end());
+    uint64_t hash = 14695981039346656037ULL;
+    for (int item : support)
+    {
+        hash ^= (uint32_t)item;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static const char *whereName(int where)
+{
+    static const char *names[] = {"polling", "presolve", "simplex", "mip", "mipsol", "mipnode", "message", "barrier", "multiobj", "iis"};
+    return where < (int)(sizeof(names) / sizeof(names[0])) ? names[where] : "other";
+}
+
+CutStats::CutStats()
+    : separationTime(0), cuts(0), lazies(0), duplicates(0), patched(0), injected(0), patchTime(0)
+{
+    std::fill(calls, calls + whereCount, 0);
+    std::fill(histogram, histogram + violationBins, 0);
+}
+
+void CutStats::call(int where)
+{
+    calls[std::min(std::max(where, 0), whereCount - 1)]++;
+}
+
+void CutStats::add(bool lazy, double violation, const std::vector<int> &support)
+{
+    if (lazy)
+        lazies++;
+    else
+        cuts++;
+    int bin = 0;
+    while (bin < violationBins - 1 && violation > violationBounds[bin])
+        bin++;
+    histogram[bin]++;
+    if (!seen.insert(supportKey(support)).second)
+        duplicates++;
+}
+
+long CutStats::totalCalls() const
+{
+    long total = 0;
+    for (int w = 0; w < whereCount; ++w)
+        total += calls[w];
+    return total;
+}
+
+void CutStats::print(std::ostream &out) const
+{
+    out << "--> Callback statistics" << std::endl;
+    out << "    calls:";
+    for (int w = 0; w < whereCount; ++w)
+    {
+        if (calls[w] > 0)
+            out << " " << whereName(w) << " " << calls[w];
+    }
+    out << std::endl;
+    out << "    separation time: " << separationTime << " sec" << std::endl;
+    out << "    cuts: " << cuts << ", lazy constraints: " << lazies << ", duplicates: " << duplicates << std::endl;
+    out << "    violations:";
+    for (int bin = 0; bin < violationBins; ++bin)
+    {
+        if (bin == 0)
+            out << " <=" << violationBounds[0];
+        else if (bin == violationBins - 1)
+            out << " >" << violationBounds[bin - 1];
+        else
+            out << " (" << violationBounds[bin - 1] << "," << violationBounds[bin] << "]";
+        out << " " << histogram[bin];
+    }
+    out << std::endl;
+    if (patchTime > 0)
+        out << "    patching: " << patched << " tours, " << injected << " injected, " << patchTime << " sec" << std::endl;
+}
+
+std::string CutStats::resultFields() const
+{
+    std::stringstream ss;
+    ss << "callbacks = " << totalCalls() << "; ";
+    ss << "separation time = " << separationTime << " sec; ";
+    ss << "cuts = " << cuts << "; ";
+    ss << "lazy constraints = " << lazies << "; ";
+    ss << "duplicate cuts = " << duplicates << "; ";
+    ss << "violations = ";
+    for (int bin = 0; bin < violationBins; ++bin)
+        ss << (bin ? "/" : "") << histogram[bin];
+    if (patchTime > 0)
+        ss << "; patched tours = " << patched << "; injected tours = " << injected << "; patching time = " << patchTime << " sec";
+    return ss.str();
+}
@@ -1,21 +1,29 @@
 #include "gurobi_c++.h"
+#include "graph.hpp"
 #include "parser.hpp"
+#include "memory.hpp"
+#include "solver.hpp"
+#include "callback.hpp"
+#include "cutlib.hpp"
 #include <cstring>
 using namespace std;
 
 int main(int argc,
          char *argv[])
 {
-    bool verbose = true;
-    if (argv[2] != NULL && strcmp(argv[2], "-nv") == 0)
-    {
-        verbose = false;
-    }
+    Config config = parseArgs(argc, argv, 600.0);
+    bool verbose = config.verbose;
     // parse and save the data
     vector<vector<int>> c = parse(argv[1]);
     int n = c.size();
 
-    GRBVar ***x = nullptr;
+    // only the arcs that can be in an optimal tour get variables
+    Graph g = buildGraph(c);
+    if (verbose)
+        printReport(g);
+    fitMemoryBudget(config, (long long)g.m * n, 5LL * g.m * n); //< --memory-budget (see memory.hpp)
+
+    GRBVar **x = nullptr;
     try
     {
         // --- Creation of the Gurobi environment ---
@@ -39,20 +47,16 @@ int main(int argc,
         if (verbose)
             cout << "--> Creating the variables" << endl;
 
-        x = new GRBVar **[n];
+        x = trackedArray<GRBVar *>(g.m);
 
-        for (size_t j = 0; j < n; ++j)
+        for (int a = 0; a < g.m; ++a)
         {
-            x[j] = new GRBVar *[n];
-            for (size_t i = 0; i < n; ++i)
+            x[a] = trackedArray<GRBVar>(n);
+            for (int k = 0; k < n; ++k)
             {
-                x[j][i] = new GRBVar[n];
-                for (size_t k = 0; k < n; ++k)
-                {
-                    stringstream ss;
-                    ss << "x(" << i << "," << j << "," << k << ")";
-                    x[j][i][k] = model.addVar(0.0, 1.0, 0.0, GRB_BINARY, ss.str());
-                }
+                stringstream ss;
+                ss << "x(" << g.tail[a] << "," << g.head[a] << "," << k << ")";
+                x[a][k] = model.addVar(0.0, 1.0, 0.0, GRB_BINARY, ss.str());
             }
         }
 
@@ -60,15 +64,11 @@ int main(int argc,
         if (verbose)
             cout << "--> Creating the objective function" << endl;
         GRBLinExpr obj = 0;
-        for (size_t i = 0; i < n; ++i)
+        for (int a = 0; a < g.m; ++a)
         {
-            for (size_t j = 0; j < n; ++j)
+            for (int k = 0; k < n; ++k)
             {
-                for (size_t k = 0; k < n; ++k)
-                {
-                    if (i != j)
-                        obj += c[j][i] * x[j][i][k];
-                }
+                obj += g.cost[a] * x[a][k];
             }
         }
         model.setObjective(obj, GRB_MINIMIZE);
@@ -80,30 +80,23 @@ int main(int argc,
         // Le sommet 0 est le seul pris en position 0
         GRBLinExpr arcDeb1 = 0;
         GRBLinExpr arcDeb2 = 0;
-        for (size_t j = 1; j < n; ++j)
+        for (int a = 0; a < g.m; ++a)
         {
-            arcDeb1 += x[j][0][0];
-            for (size_t i = 1; i < n; ++i)
-            {
-                arcDeb2 += x[j][i][0];
-            }
+            if (g.tail[a] == 0)
+                arcDeb1 += x[a][0];
+            else
+                arcDeb2 += x[a][0];
         }
         model.addConstr(arcDeb1 == 1);
         model.addConstr(arcDeb2 == 0);
 
         // Respect 1 flot à tout niveau k
-        for (size_t k = 0; k < n; ++k)
+        for (int k = 0; k < n; ++k)
         {
             GRBLinExpr flot = 0;
-            for (size_t j = 0; j < n; ++j)
+            for (int a = 0; a < g.m; ++a)
             {
-                for (size_t i = 0; i < n; ++i)
-                {
-                    if (i != j)
-                    {
-                        flot += x[i][j][k];
-                    }
-                }
+                flot += x[a][k];
             }
             stringstream ss;
             ss << "Flot(" << k << ")";
@@ -111,19 +104,19 @@ int main(int argc,
         }
 
         // Respect flot à tout noeud (j,k)
-        for (size_t k = 1; k < n; ++k)
+        for (int k = 1; k < n; ++k)
         {
-            for (size_t j = 1; j < n; ++j)
+            for (int j = 1; j < n; ++j)
             {
                 GRBLinExpr flot1 = 0;
                 GRBLinExpr flot2 = 0;
-                for (size_t i = 0; i < n; ++i)
+                for (int p = g.inStart[j]; p < g.inStart[j + 1]; ++p)
                 {
-                    if (i != j)
-                    {
-                        flot1 += x[j][i][k - 1];
-                        flot2 += x[i][j][k];
-                    }
+                    flot1 += x[g.inArc[p]][k - 1];
+                }
+                for (int a = g.outStart[j]; a < g.outStart[j + 1]; ++a)
+                {
+                    flot2 += x[a][k];
                 }
                 stringstream ss;
                 ss << "Flot(" << j << "," << k << ")";
@@ -132,19 +125,19 @@ int main(int argc,
         }
 
         // Respect flot pour chaque sommet j
-        for (size_t j = 1; j < n; ++j)
+        for (int j = 1; j < n; ++j)
         {
             GRBLinExpr flot1 = 0;
             GRBLinExpr flot2 = 0;
-            for (size_t k = 0; k < n; ++k)
+            for (int k = 0; k < n; ++k)
             {
-                for (size_t i = 0; i < n; ++i)
+                for (int a = g.outStart[j]; a < g.outStart[j + 1]; ++a)
                 {
-                    if (i != j)
-                    {
-                        flot1 += x[j][i][k];
-                        flot2 += x[i][j][k];
-                    }
+                    flot1 += x[a][k];
+                }
+                for (int p = g.inStart[j]; p < g.inStart[j + 1]; ++p)
+                {
+                    flot2 += x[g.inArc[p]][k];
                 }
             }
             stringstream ss;
@@ -157,13 +150,12 @@ int main(int argc,
         // On retourne sur le sommet 0 en dernière position
         GRBLinExpr arcSor1 = 0;
         GRBLinExpr arcSor2 = 0;
-        for (size_t i = 1; i < n; ++i)
+        for (int a = 0; a < g.m; ++a)
         {
-            arcSor1 += x[0][i][n - 1];
-            for (size_t j = 1; j < n; ++j)
-            {
-                arcSor2 += x[j][i][n - 1];
-            }
+            if (g.head[a] == 0)
+                arcSor1 += x[a][n - 1];
+            else
+                arcSor2 += x[a][n - 1];
         }
         model.addConstr(arcSor1 == 1);
         model.addConstr(arcSor2 == 0);
@@ -172,13 +164,21 @@ int main(int argc,
         // --- Solver configuration ---
         if (verbose)
             cout << "--> Configuring the solver" << endl;
-        model.set(GRB_DoubleParam_TimeLimit, 600.0); //< sets the time limit (in seconds)
-        model.set(GRB_IntParam_Threads, 3);          //< limits the solver to single thread usage
+        configure(model, config, "flot", n); //< time limit, threads and parameters (see config.hpp)
+
+        ModelCallback cb; //< samples the progress of the solver (see callback.hpp)
+        model.setCallback(&cb);
+        ArcVariables arcs(&g); //< --incumbents, --stop-file and --checkpoint
+        for (int a = 0; a < g.m; ++a)
+            for (int k = 0; k < n; ++k)
+                arcs.add(x[a][k], a);
+        cb.watch(config, arcs, instanceHash(c));
 
         // --- Solver launch ---
         if (verbose)
             cout << "--> Running the solver" << endl;
         model.optimize();
+        finishCallback(model, cb, config);
         // model.write("model.lp"); //< Writes the model in a file
 
         // --- Solver results retrieval ---
@@ -186,9 +186,9 @@ int main(int argc,
             cout << "--> Retrieving solver results " << endl;
 
         int status = model.get(GRB_IntAttr_Status);
-        if (status == GRB_OPTIMAL || (status == GRB_TIME_LIMIT && model.get(GRB_IntAttr_SolCount) > 0))
+        if (status == GRB_OPTIMAL || ((status == GRB_TIME_LIMIT || status == GRB_INTERRUPTED) && model.get(GRB_IntAttr_SolCount) > 0))
         {
-            // the solver has computed the optimal solution or a feasible solution (when the time limit is reached before proving optimality)
+            // the solver has computed the optimal solution or a feasible solution (when the time limit is reached or the run is stopped before proving optimality)
             if (verbose)
             {
                 cout << "Success! (Status: " << status << ")" << endl; //< prints the solver status (see the gurobi documentation)
@@ -198,28 +198,30 @@ int main(int argc,
             cout << "Result: ";
             cout << argv[1] << "; ";
             cout << "runtime = " << model.get(GRB_DoubleAttr_Runtime) << " sec; ";
-            cout << "objective value = " << model.get(GRB_DoubleAttr_ObjVal) << endl; //< gets the value of the objective function for the best computed solution (optimal if no time limit)
+            cout << "objective value = " << model.get(GRB_DoubleAttr_ObjVal) << "; "; //< gets the value of the objective function for the best computed solution (optimal if no time limit)
+            cout << "primal-dual integral = " << cb.trace.primalDualIntegral() << "; root bound = " << cb.trace.rootBound() << "; "; //< integral of the primal-dual gap over time (see trace.hpp)
+            cout << cb.stats.resultFields() << "; " << resourceFields(model) << endl; //< callback counters (see cutstats.hpp), model size and memory (see memory.hpp)
 
             if (verbose)
             {
-                int i = 0;
-                int k = 0;
-                for (size_t j = 0; j < n; ++j)
+                vector<int> succ(n, -1);
+                for (int a = 0; a < g.m; ++a)
                 {
-                    if (k == n)
-                        break;
-                    // cout << x[j][i][k].get(GRB_DoubleAttr_X) << endl;
-                    if (x[j][i][k].get(GRB_DoubleAttr_X) >= 0.5)
+                    for (int k = 0; k < n; ++k)
                     {
-                        cout << "ville " << i << " --> "
-                             << "ville " << j << endl;
-                        i = j;
-                        if (i == 0)
-                            break;
-                        j = -1;
-                        k++;
+                        if (x[a][k].get(GRB_DoubleAttr_X) >= 0.5)
+                            succ[g.tail[a]] = g.head[a];
                     }
                 }
+                int i = 0;
+                for (int k = 0; k < n && succ[i] >= 0; ++k)
+                {
+                    cout << "ville " << cb.city(i) << " --> "
+                         << "ville " << cb.city(succ[i]) << endl;
+                    i = succ[i];
+                    if (i == 0)
+                        break;
+                }
             }
             // model.write("solution.sol"); //< Writes the solution in a file
         }
@@ -239,11 +241,9 @@ int main(int argc,
         cout << "Exception during optimization" << endl;
     }
 
-    for (size_t j = 0; j < n; ++j)
+    for (int a = 0; x != nullptr && a < g.m; ++a)
     {
-        for (size_t i = 0; i < n; ++i)
-            delete[] x[j][i];
-        delete[] x[j];
+        delete[] x[a];
     }
     delete[] x;
 
@@ -1,21 +1,34 @@
 #include "gurobi_c++.h"
+#include "graph.hpp"
 #include "parser.hpp"
+#include "memory.hpp"
+#include "solver.hpp"
+#include "callback.hpp"
+#include "cutlib.hpp"
+#include "separation.hpp"
 #include <cstring>
 using namespace std;
 
 int main(int argc,
          char *argv[])
 {
-    bool verbose = true;
-    if (argv[2] != NULL && strcmp(argv[2], "-nv") == 0)
-    {
-        verbose = false;
-    }
+    Config config = parseArgs(argc, argv, 60.0);
+    bool verbose = config.verbose;
     // parse and save the data
     vector<vector<int>> c = parse(argv[1]);
     int n = c.size();
 
-    GRBVar ***x = nullptr;
+    // only the arcs that can be in an optimal tour get variables
+    Graph g = buildGraph(c);
+    if (verbose)
+        printReport(g);
+    long long vars = 0;
+    for (int a = 0; a < g.m; ++a)
+        for (int k = 0; k < n; ++k)
+            vars += flotArc(g.tail[a], g.head[a], k, n);
+    fitMemoryBudget(config, vars, 5 * vars); //< --memory-budget (see memory.hpp)
+
+    GRBVar **x = nullptr;
     try
     {
         // --- Creation of the Gurobi environment ---
@@ -39,23 +52,19 @@ int main(int argc,
         if (verbose)
             cout << "--> Creating the variables" << endl;
 
-        x = new GRBVar **[n];
+        x = trackedArray<GRBVar *>(g.m);
 
-        for (size_t i = 0; i < n; ++i)
+        for (int a = 0; a < g.m; ++a)
         {
-            x[i] = new GRBVar *[n];
-            for (size_t j = 0; j < n; ++j)
+            int i = g.tail[a], j = g.head[a];
+            x[a] = trackedArray<GRBVar>(n);
+            for (int k = 0; k < n; ++k)
             {
-                x[i][j] = new GRBVar[n];
-                for (size_t k = 0; k < n; ++k)
+                if (flotArc(i, j, k, n))
                 {
-                    if (i != j && (i == 0 || k != 0) && (i != 0 || k == 0) && (j == 0 || k != n - 1) && (j != 0 || k == n - 1))
-                    {
-                        // cout << "x(" << i << "," << j << "," << k << ")" << endl;
-                        stringstream ss;
-                        ss << "x(" << i << "," << j << "," << k << ")";
-                        x[i][j][k] = model.addVar(0.0, 1.0, 0.0, GRB_BINARY, ss.str());
-                    }
+                    stringstream ss;
+                    ss << "x(" << i << "," << j << "," << k << ")";
+                    x[a][k] = model.addVar(0.0, 1.0, 0.0, GRB_BINARY, ss.str());
                 }
             }
         }
@@ -64,15 +73,12 @@ int main(int argc,
         if (verbose)
             cout << "--> Creating the objective function" << endl;
         GRBLinExpr obj = 0;
-        for (size_t i = 0; i < n; ++i)
+        for (int a = 0; a < g.m; ++a)
         {
-            for (size_t j = 0; j < n; ++j)
+            for (int k = 0; k < n; ++k)
             {
-                for (size_t k = 0; k < n; ++k)
-                {
-                    if (i != j && (i == 0 || k != 0) && (i != 0 || k == 0) && (j == 0 || k != n - 1) && (j != 0 || k == n - 1))
-                        obj += c[i][j] * x[i][j][k];
-                }
+                if (flotArc(g.tail[a], g.head[a], k, n))
+                    obj += g.cost[a] * x[a][k];
             }
         }
         model.setObjective(obj, GRB_MINIMIZE);
@@ -81,26 +87,23 @@ int main(int argc,
         if (verbose)
             cout << "--> Creating the constraints" << endl;
 
-        // Le sommet 0 est le seul pris en position 0 ****** maybe unnecessary
+        // Le sommet 0 est le seul pris en position 0
         GRBLinExpr arcDeb = 0;
-        for (size_t j = 1; j < n; ++j)
+        for (int a = g.outStart[0]; a < g.outStart[1]; ++a)
         {
-            arcDeb += x[0][j][0];
+            arcDeb += x[a][0];
         }
         model.addConstr(arcDeb == 1);
 
-        // Respect 1 flot � tout niveau k
-        for (size_t k = 0; k < n; ++k)
+        // Respect 1 flot à tout niveau k
+        for (int k = 0; k < n; ++k)
         {
             GRBLinExpr flot = 0;
-            for (size_t i = 0; i < n; ++i)
+            for (int a = 0; a < g.m; ++a)
             {
-                for (size_t j = 0; j < n; ++j)
+                if (flotArc(g.tail[a], g.head[a], k, n))
                 {
-                    if (i != j && (i == 0 || k != 0) && (i != 0 || k == 0) && (j == 0 || k != n - 1) && (j != 0 || k == n - 1))
-                    {
-                        flot += x[i][j][k];
-                    }
+                    flot += x[a][k];
                 }
             }
             stringstream ss;
@@ -108,26 +111,23 @@ int main(int argc,
             model.addConstr(flot == 1, ss.str());
         }
 
-        // Respect flot � tout noeud (j,k)
-        for (size_t k = 1; k < n; ++k)
+        // Respect flot à tout noeud (j,k)
+        for (int k = 1; k < n; ++k)
         {
-            for (size_t j = 1; j < n; ++j)
+            for (int j = 1; j < n; ++j)
             {
                 GRBLinExpr flot1 = 0;
                 GRBLinExpr flot2 = 0;
-                for (size_t i = 0; i < n; ++i)
+                for (int p = g.inStart[j]; p < g.inStart[j + 1]; ++p)
                 {
-                    if (i != j && (i == 0 || k - 1 != 0) && (i != 0 || k - 1 == 0) && (j == 0 || k - 1 != n - 1) && (j != 0 || k - 1 == n - 1))
-                    {
-                        // cout << "x1(" << i << "," << j << "," << k-1 << ")" << endl;
-
-                        flot1 += x[i][j][k - 1];
-                    }
-                    if (j != i && (j == 0 || k != 0) && (j != 0 || k == 0) && (i == 0 || k != n - 1) && (i != 0 || k == n - 1))
-                    {
-                        // cout << "x2(" << j << "," << i << "," << k << ")" << endl;
-                        flot2 += x[j][i][k];
-                    }
+                    int a = g.inArc[p];
+                    if (flotArc(g.tail[a], j, k - 1, n))
+                        flot1 += x[a][k - 1];
+                }
+                for (int a = g.outStart[j]; a < g.outStart[j + 1]; ++a)
+                {
+                    if (flotArc(j, g.head[a], k, n))
+                        flot2 += x[a][k];
                 }
                 stringstream ss;
                 ss << "Flot(" << j << "," << k << ")";
@@ -136,22 +136,22 @@ int main(int argc,
         }
 
         // Respect flot pour chaque sommet j
-        for (size_t j = 0; j < n; ++j)
+        for (int j = 0; j < n; ++j)
         {
             GRBLinExpr flot1 = 0;
             GRBLinExpr flot2 = 0;
-            for (size_t k = 0; k < n; ++k)
+            for (int k = 0; k < n; ++k)
             {
-                for (size_t i = 0; i < n; ++i)
+                for (int p = g.inStart[j]; p < g.inStart[j + 1]; ++p)
                 {
-                    if (i != j && (i == 0 || k != 0) && (i != 0 || k == 0) && (j == 0 || k != n - 1) && (j != 0 || k == n - 1))
-                    {
-                        flot1 += x[i][j][k];
-                    }
-                    if (j != i && (j == 0 || k != 0) && (j != 0 || k == 0) && (i == 0 || k != n - 1) && (i != 0 || k == n - 1))
-                    {
-                        flot2 += x[j][i][k];
-                    }
+                    int a = g.inArc[p];
+                    if (flotArc(g.tail[a], j, k, n))
+                        flot1 += x[a][k];
+                }
+                for (int a = g.outStart[j]; a < g.outStart[j + 1]; ++a)
+                {
+                    if (flotArc(j, g.head[a], k, n))
+                        flot2 += x[a][k];
                 }
             }
             stringstream ss;
@@ -161,11 +161,11 @@ int main(int argc,
             model.addConstr(flot2 == 1, ss.str());
         }
 
-        // On retourne sur le sommet 0 en derni�re position
+        // On retourne sur le sommet 0 en dernière position
         GRBLinExpr arcSor = 0;
-        for (size_t i = 1; i < n; ++i)
+        for (int p = g.inStart[0]; p < g.inStart[1]; ++p)
         {
-            arcSor += x[i][0][n - 1];
+            arcSor += x[g.inArc[p]][n - 1];
         }
         model.addConstr(arcSor == 1);
 
@@ -173,13 +173,22 @@ int main(int argc,
         // --- Solver configuration ---
         if (verbose)
             cout << "--> Configuring the solver" << endl;
-        model.set(GRB_DoubleParam_TimeLimit, 60.0); //< sets the time limit (in seconds)
-        model.set(GRB_IntParam_Threads, 3);         //< limits the solver to single thread usage
+        configure(model, config, "flot_am", n); //< time limit, threads and parameters (see config.hpp)
+
+        ModelCallback cb; //< samples the progress of the solver (see callback.hpp)
+        model.setCallback(&cb);
+        ArcVariables arcs(&g); //< --incumbents, --stop-file and --checkpoint
+        for (int a = 0; a < g.m; ++a)
+            for (int k = 0; k < n; ++k)
+                if (flotArc(g.tail[a], g.head[a], k, n))
+                    arcs.add(x[a][k], a);
+        cb.watch(config, arcs, instanceHash(c));
 
         // --- Solver launch ---
         if (verbose)
             cout << "--> Running the solver" << endl;
         model.optimize();
+        finishCallback(model, cb, config);
         // model.write("model.lp"); //< Writes the model in a file
 
         // --- Solver results retrieval ---
@@ -187,9 +196,9 @@ int main(int argc,
             cout << "--> Retrieving solver results " << endl;
 
         int status = model.get(GRB_IntAttr_Status);
-        if (status == GRB_OPTIMAL || (status == GRB_TIME_LIMIT && model.get(GRB_IntAttr_SolCount) > 0))
+        if (status == GRB_OPTIMAL || ((status == GRB_TIME_LIMIT || status == GRB_INTERRUPTED) && model.get(GRB_IntAttr_SolCount) > 0))
         {
-            // the solver has computed the optimal solution or a feasible solution (when the time limit is reached before proving optimality)
+            // the solver has computed the optimal solution or a feasible solution (when the time limit is reached or the run is stopped before proving optimality)
             if (verbose)
             {
                 cout << "Success! (Status: " << status << ")" << endl; //< prints the solver status (see the gurobi documentation)
@@ -199,30 +208,30 @@ int main(int argc,
             cout << "Result: ";
             cout << argv[1] << "; ";
             cout << "runtime = " << model.get(GRB_DoubleAttr_Runtime) << " sec; ";
-            cout << "objective value = " << model.get(GRB_DoubleAttr_ObjVal) << endl; //< gets the value of the objective function for the best computed solution (optimal if no time limit)
+            cout << "objective value = " << model.get(GRB_DoubleAttr_ObjVal) << "; "; //< gets the value of the objective function for the best computed solution (optimal if no time limit)
+            cout << "primal-dual integral = " << cb.trace.primalDualIntegral() << "; root bound = " << cb.trace.rootBound() << "; "; //< integral of the primal-dual gap over time (see trace.hpp)
+            cout << cb.stats.resultFields() << "; " << resourceFields(model) << endl; //< callback counters (see cutstats.hpp), model size and memory (see memory.hpp)
 
             if (verbose)
             {
-                int i = 0;
-                int k = 0;
-                for (size_t j = 0; j < n; ++j)
+                vector<int> succ(n, -1);
+                for (int a = 0; a < g.m; ++a)
                 {
-                    if (k == n)
-                        break;
-                    if (i != j && (i == 0 || k != 0) && (i != 0 || k == 0) && (j == 0 || k != n - 1) && (j != 0 || k == n - 1))
+                    for (int k = 0; k < n; ++k)
                     {
-                        if (x[i][j][k].get(GRB_DoubleAttr_X) >= 0.5)
-                        {
-                            cout << "ville " << i << " --> "
-                                 << "ville " << j << endl;
-                            i = j;
-                            if (i == 0)
-                                break;
-                            j = -1;
-                            k++;
-                        }
+                        if (flotArc(g.tail[a], g.head[a], k, n) && x[a][k].get(GRB_DoubleAttr_X) >= 0.5)
+                            succ[g.tail[a]] = g.head[a];
                     }
                 }
+                int i = 0;
+                for (int k = 0; k < n && succ[i] >= 0; ++k)
+                {
+                    cout << "ville " << cb.city(i) << " --> "
+                         << "ville " << cb.city(succ[i]) << endl;
+                    i = succ[i];
+                    if (i == 0)
+                        break;
+                }
             }
             // model.write("solution.sol"); //< Writes the solution in a file
         }
@@ -242,11 +251,9 @@ int main(int argc,
         cout << "Exception during optimization" << endl;
     }
 
-    for (size_t j = 0; j < n; ++j)
+    for (int a = 0; x != nullptr && a < g.m; ++a)
     {
-        for (size_t i = 0; i < n; ++i)
-            delete[] x[j][i];
-        delete[] x[j];
+        delete[] x[a];
     }
     delete[] x;
 
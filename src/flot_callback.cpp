@@ -1,61 +1,81 @@
 #include "gurobi_c++.h"
+#include "graph.hpp"
 #include "parser.hpp"
+#include "memory.hpp"
+#include "solver.hpp"
+#include "callback.hpp"
+#include "cutlib.hpp"
+#include "separation.hpp"
+#include <cmath>
 #include <cstring>
 using namespace std;
 
 bool verbose = true;
 
-class Callback : public GRBCallback
+// linking cut x(i,j,k) <= sum_l x(j,l,k+1): the flow entering j at position k leaves it at k+1
+static GRBTempConstr linkingCut(GRBVar **x, const Graph &g, int i, int j, int k)
+{
+    GRBLinExpr _inVal = 0;
+    for (int a = g.outStart[j]; a < g.outStart[j + 1]; ++a)
+        if (g.head[a] != i && flotArc(j, g.head[a], k + 1, g.n))
+            _inVal += x[a][k + 1];
+    return x[g.arc(i, j)][k] <= _inVal;
+}
+
+class Callback : public ModelCallback
 {
 public:
-    GRBVar ***_x;
+    GRBVar **_x;
+    const Graph *g;
     int n;
+    vector<GRBVar> vars;   ///< existing variables x(i,j,k), in the order of positions
+    vector<int> positions; ///< index of each variable in the dense n x n x n relaxation
+    string capture;        ///< file receiving the first node relaxation (bench fixture), empty if none
+    vector<vector<int>> links; ///< (i, j, k) of the linking cuts added, for the checkpoints
 
     /**
        The constructor is used to get a pointer to the variables that are needed.
      */
-    Callback(GRBVar ***x, int nb)
+    Callback(GRBVar **x, const Graph *graph, string capturePath = "")
     {
         _x = x;
-        n = nb;
+        g = graph;
+        n = graph->n;
+        capture = capturePath;
+        for (int a = 0; a < g->m; ++a)
+            for (int k = 0; k < n; ++k)
+                if (flotArc(g->tail[a], g->head[a], k, n))
+                {
+                    vars.push_back(_x[a][k]);
+                    positions.push_back((g->tail[a] * n + g->head[a]) * n + k);
+                }
     }
 
 protected:
-    void callback()
+    void separate()
     {
         try
         {
             if (where == GRB_CB_MIPNODE && getIntInfo(GRB_CB_MIPNODE_STATUS) == GRB_OPTIMAL)
             {
-                for (size_t i = 0; i < n; ++i)
+                vector<double> xVal(n * n * n, 0.0);
+                double *rel = getNodeRel(vars.data(), vars.size());
+                for (size_t v = 0; v < vars.size(); ++v)
+                    xVal[positions[v]] = rel[v];
+                delete[] rel;
+                if (!capture.empty())
                 {
-                    for (size_t j = 0; j < n; ++j)
-                    {
-                        for (size_t k = 1; k < n - 2; ++k)
-                        {
-                            double inVal = 0;
-                            for (size_t l = 0; l < n; l++)
-                            {
-                                if (l != i && j != l && (j == 0 || k + 1 != 0) && (j != 0 || k + 1 == 0) && (l == 0 || k + 1 != n - 1) && (l != 0 || k + 1 == n - 1))
-                                    inVal += getNodeRel(_x[j][l][k + 1]);
-                            }
-                            if (i != j && (i == 0 || k != 0) && (i != 0 || k == 0) && (j == 0 || k != n - 1) && (j != 0 || k == n - 1))
-                            {
-
-                                double xVal = getNodeRel(_x[i][j][k]);
-                                if (xVal > inVal)
-                                {
-                                    // if (verbose)
-                                    //     cout << "Constraint not satisfied : xVal <= inVal. Adding this constraint." << endl;
-                                    GRBLinExpr _inVal = 0;
-                                    for (size_t l = 0; l < n; l++)
-                                        if (l != i && j != l && (j == 0 || k + 1 != 0) && (j != 0 || k + 1 == 0) && (l == 0 || k + 1 != n - 1) && (l != 0 || k + 1 == n - 1))
-                                            _inVal += _x[j][l][k + 1];
-                                    addCut(_x[i][j][k] <= _inVal);
-                                }
-                            }
-                        }
-                    }
+                    writeRelaxation(capture, xVal, n, 3);
+                    capture.clear();
+                }
+
+                for (const FlotCut &cut : flotLinkingViolations(xVal.data(), n))
+                {
+                    int i = cut.i, j = cut.j, k = cut.k;
+                    if (g->arc(i, j) < 0) // arcs out of the graph are at 0
+                        continue;
+                    addCut(linkingCut(_x, *g, i, j, k), cut.violation, {i, n + j, 2 * n + k});
+                    links.push_back({i, j, k});
                 }
             }
         }
@@ -69,21 +89,41 @@ protected:
             cout << "Error during callback" << endl;
         }
     }
+
+    void saveCuts(Checkpoint &checkpoint) const
+    {
+        checkpoint.links.insert(checkpoint.links.end(), links.begin(), links.end());
+    }
 };
 
 int main(int argc,
          char *argv[])
 {
-    bool verbose = true;
-    if (argv[2] != NULL && strcmp(argv[2], "-nv") == 0)
-    {
-        verbose = false;
-    }
+    Config config = parseArgs(argc, argv, 60.0);
+    bool verbose = config.verbose;
+    string capture = config.get("capture"); ///< --capture=<file> dumps the root relaxation as a bench fixture
     // parse and save the data
     vector<vector<int>> c = parse(argv[1]);
     int n = c.size();
 
-    GRBVar ***x = nullptr;
+    // only the arcs that can be in an optimal tour get variables
+    Graph g = buildGraph(c);
+    if (verbose)
+        printReport(g);
+    long long vars = 0;
+    for (int a = 0; a < g.m; ++a)
+        for (int k = 0; k < n; ++k)
+            vars += flotArc(g.tail[a], g.head[a], k, n);
+    fitMemoryBudget(config, vars, 5 * vars); //< --memory-budget (see memory.hpp)
+
+    // --resume: the checkpoint of --checkpoint, if there is one already (see checkpoint.hpp)
+    Checkpoint state;
+    state.n = n;
+    state.instance = instanceHash(c);
+    if (config.has("resume") && !readCheckpoint(config.get("checkpoint"), c, state) && verbose)
+        cout << "--> No checkpoint to resume from: " << config.get("checkpoint") << endl;
+
+    GRBVar **x = nullptr;
     try
     {
         // --- Creation of the Gurobi environment ---
@@ -109,23 +149,19 @@ int main(int argc,
         if (verbose)
             cout << "--> Creating the variables" << endl;
 
-        x = new GRBVar **[n];
+        x = trackedArray<GRBVar *>(g.m);
 
-        for (size_t i = 0; i < n; ++i)
+        for (int a = 0; a < g.m; ++a)
         {
-            x[i] = new GRBVar *[n];
-            for (size_t j = 0; j < n; ++j)
+            int i = g.tail[a], j = g.head[a];
+            x[a] = trackedArray<GRBVar>(n);
+            for (int k = 0; k < n; ++k)
             {
-                x[i][j] = new GRBVar[n];
-                for (size_t k = 0; k < n; ++k)
+                if (flotArc(i, j, k, n))
                 {
-                    if (i != j && (i == 0 || k != 0) && (i != 0 || k == 0) && (j == 0 || k != n - 1) && (j != 0 || k == n - 1))
-                    {
-                        // cout << "x(" << i << "," << j << "," << k << ")" << endl;
-                        stringstream ss;
-                        ss << "x(" << i << "," << j << "," << k << ")";
-                        x[i][j][k] = model.addVar(0.0, 1.0, 0.0, GRB_BINARY, ss.str());
-                    }
+                    stringstream ss;
+                    ss << "x(" << i << "," << j << "," << k << ")";
+                    x[a][k] = model.addVar(0.0, 1.0, 0.0, GRB_BINARY, ss.str());
                 }
             }
         }
@@ -134,15 +170,12 @@ int main(int argc,
         if (verbose)
             cout << "--> Creating the objective function" << endl;
         GRBLinExpr obj = 0;
-        for (size_t i = 0; i < n; ++i)
+        for (int a = 0; a < g.m; ++a)
         {
-            for (size_t j = 0; j < n; ++j)
+            for (int k = 0; k < n; ++k)
             {
-                for (size_t k = 0; k < n; ++k)
-                {
-                    if (i != j && (i == 0 || k != 0) && (i != 0 || k == 0) && (j == 0 || k != n - 1) && (j != 0 || k == n - 1))
-                        obj += c[i][j] * x[i][j][k];
-                }
+                if (flotArc(g.tail[a], g.head[a], k, n))
+                    obj += g.cost[a] * x[a][k];
             }
         }
         model.setObjective(obj, GRB_MINIMIZE);
@@ -151,26 +184,23 @@ int main(int argc,
         if (verbose)
             cout << "--> Creating the constraints" << endl;
 
-        // Le sommet 0 est le seul pris en position 0 ****** maybe unnecessary
+        // Le sommet 0 est le seul pris en position 0
         GRBLinExpr arcDeb = 0;
-        for (size_t j = 1; j < n; ++j)
+        for (int a = g.outStart[0]; a < g.outStart[1]; ++a)
         {
-            arcDeb += x[0][j][0];
+            arcDeb += x[a][0];
         }
         model.addConstr(arcDeb == 1);
 
-        // Respect 1 flot � tout niveau k
-        for (size_t k = 0; k < n; ++k)
+        // Respect 1 flot à tout niveau k
+        for (int k = 0; k < n; ++k)
         {
             GRBLinExpr flot = 0;
-            for (size_t i = 0; i < n; ++i)
+            for (int a = 0; a < g.m; ++a)
             {
-                for (size_t j = 0; j < n; ++j)
+                if (flotArc(g.tail[a], g.head[a], k, n))
                 {
-                    if (i != j && (i == 0 || k != 0) && (i != 0 || k == 0) && (j == 0 || k != n - 1) && (j != 0 || k == n - 1))
-                    {
-                        flot += x[i][j][k];
-                    }
+                    flot += x[a][k];
                 }
             }
             stringstream ss;
@@ -178,26 +208,23 @@ int main(int argc,
             model.addConstr(flot == 1, ss.str());
         }
 
-        // Respect flot � tout noeud (j,k)
-        for (size_t k = 1; k < n; ++k)
+        // Respect flot à tout noeud (j,k)
+        for (int k = 1; k < n; ++k)
         {
-            for (size_t j = 1; j < n; ++j)
+            for (int j = 1; j < n; ++j)
             {
                 GRBLinExpr flot1 = 0;
                 GRBLinExpr flot2 = 0;
-                for (size_t i = 0; i < n; ++i)
+                for (int p = g.inStart[j]; p < g.inStart[j + 1]; ++p)
                 {
-                    if (i != j && (i == 0 || k - 1 != 0) && (i != 0 || k - 1 == 0) && (j == 0 || k - 1 != n - 1) && (j != 0 || k - 1 == n - 1))
-                    {
-                        // cout << "x1(" << i << "," << j << "," << k-1 << ")" << endl;
-
-                        flot1 += x[i][j][k - 1];
-                    }
-                    if (j != i && (j == 0 || k != 0) && (j != 0 || k == 0) && (i == 0 || k != n - 1) && (i != 0 || k == n - 1))
-                    {
-                        // cout << "x2(" << j << "," << i << "," << k << ")" << endl;
-                        flot2 += x[j][i][k];
-                    }
+                    int a = g.inArc[p];
+                    if (flotArc(g.tail[a], j, k - 1, n))
+                        flot1 += x[a][k - 1];
+                }
+                for (int a = g.outStart[j]; a < g.outStart[j + 1]; ++a)
+                {
+                    if (flotArc(j, g.head[a], k, n))
+                        flot2 += x[a][k];
                 }
                 stringstream ss;
                 ss << "Flot(" << j << "," << k << ")";
@@ -206,22 +233,22 @@ int main(int argc,
         }
 
         // Respect flot pour chaque sommet j
-        for (size_t j = 0; j < n; ++j)
+        for (int j = 0; j < n; ++j)
         {
             GRBLinExpr flot1 = 0;
             GRBLinExpr flot2 = 0;
-            for (size_t k = 0; k < n; ++k)
+            for (int k = 0; k < n; ++k)
             {
-                for (size_t i = 0; i < n; ++i)
+                for (int p = g.inStart[j]; p < g.inStart[j + 1]; ++p)
                 {
-                    if (i != j && (i == 0 || k != 0) && (i != 0 || k == 0) && (j == 0 || k != n - 1) && (j != 0 || k == n - 1))
-                    {
-                        flot1 += x[i][j][k];
-                    }
-                    if (j != i && (j == 0 || k != 0) && (j != 0 || k == 0) && (i == 0 || k != n - 1) && (i != 0 || k == n - 1))
-                    {
-                        flot2 += x[j][i][k];
-                    }
+                    int a = g.inArc[p];
+                    if (flotArc(g.tail[a], j, k, n))
+                        flot1 += x[a][k];
+                }
+                for (int a = g.outStart[j]; a < g.outStart[j + 1]; ++a)
+                {
+                    if (flotArc(j, g.head[a], k, n))
+                        flot2 += x[a][k];
                 }
             }
             stringstream ss;
@@ -231,29 +258,56 @@ int main(int argc,
             model.addConstr(flot2 == 1, ss.str());
         }
 
-        // On retourne sur le sommet 0 en derni�re position
+        // On retourne sur le sommet 0 en dernière position
         GRBLinExpr arcSor = 0;
-        for (size_t i = 1; i < n; ++i)
+        for (int p = g.inStart[0]; p < g.inStart[1]; ++p)
         {
-            arcSor += x[i][0][n - 1];
+            arcSor += x[g.inArc[p]][n - 1];
         }
         model.addConstr(arcSor == 1);
 
+        // the linking cuts, tour and bound of the checkpoint: the cuts are
+        // constraints from the start and the tour, ranked from city 0, is the MIP start
+        for (const vector<int> &link : state.links)
+            if (g.arc(link[0], link[1]) >= 0)
+                model.addConstr(linkingCut(x, g, link[0], link[1], link[2]));
+        if (!state.succ.empty())
+        {
+            for (int i = 0, k = 0; k < n; ++k)
+            {
+                int a = g.arc(i, state.succ[i]);
+                if (a >= 0 && flotArc(i, state.succ[i], k, n))
+                    x[a][k].set(GRB_DoubleAttr_Start, 1.0);
+                i = state.succ[i];
+            }
+        }
+        if (isfinite(state.bound))
+            model.addConstr(obj >= ceil(state.bound - 1e-6), "Bound");
+        if (verbose && config.has("resume"))
+            cout << "--> Resuming: " << state.links.size() << " linking cuts, bound " << state.bound << ", " << state.runtime << " sec" << endl;
+
         // Optimize model
         // --- Solver configuration ---
         if (verbose)
             cout << "--> Configuring the solver" << endl;
-        model.set(GRB_DoubleParam_TimeLimit, 60.0); //< sets the time limit (in seconds)
-        model.set(GRB_IntParam_Threads, 3);         //< limits the solver to single thread usage
+        configure(model, config, "flot_callback", n); //< time limit, threads and parameters (see config.hpp)
 
         // Callback
-        Callback *cb = new Callback(x, n); // passing variable x to the solver callback
-        model.setCallback(cb);             // adding the callback to the model
+        Callback *cb = new Callback(x, &g, capture); // passing variable x to the solver callback
+        model.setCallback(cb);                       // adding the callback to the model
+        ArcVariables arcs(&g); //< --incumbents, --stop-file and --checkpoint
+        for (int a = 0; a < g.m; ++a)
+            for (int k = 0; k < n; ++k)
+                if (flotArc(g.tail[a], g.head[a], k, n))
+                    arcs.add(x[a][k], a);
+        cb->watch(config, arcs, state.instance);
+        cb->resume(state);
 
         // --- Solver launch ---
         if (verbose)
             cout << "--> Running the solver" << endl;
         model.optimize();
+        finishCallback(model, *cb, config);
         // model.write("model.lp"); //< Writes the model in a file
 
         // --- Solver results retrieval ---
@@ -261,9 +315,9 @@ int main(int argc,
             cout << "--> Retrieving solver results " << endl;
 
         int status = model.get(GRB_IntAttr_Status);
-        if (status == GRB_OPTIMAL || (status == GRB_TIME_LIMIT && model.get(GRB_IntAttr_SolCount) > 0))
+        if (status == GRB_OPTIMAL || ((status == GRB_TIME_LIMIT || status == GRB_INTERRUPTED) && model.get(GRB_IntAttr_SolCount) > 0))
         {
-            // the solver has computed the optimal solution or a feasible solution (when the time limit is reached before proving optimality)
+            // the solver has computed the optimal solution or a feasible solution (when the time limit is reached or the run is stopped before proving optimality)
             if (verbose)
             {
                 cout << "Success! (Status: " << status << ")" << endl; //< prints the solver status (see the gurobi documentation)
@@ -273,30 +327,33 @@ int main(int argc,
             cout << "Result: ";
             cout << argv[1] << "; ";
             cout << "runtime = " << model.get(GRB_DoubleAttr_Runtime) << " sec; ";
-            cout << "objective value = " << model.get(GRB_DoubleAttr_ObjVal) << endl; //< gets the value of the objective function for the best computed solution (optimal if no time limit)
+            cout << "objective value = " << model.get(GRB_DoubleAttr_ObjVal) << "; "; //< gets the value of the objective function for the best computed solution (optimal if no time limit)
+            cout << "primal-dual integral = " << cb->trace.primalDualIntegral() << "; root bound = " << cb->trace.rootBound() << "; "; //< integral of the primal-dual gap over time (see trace.hpp)
+            cout << cb->stats.resultFields() << "; " << resourceFields(model); //< callback counters (see cutstats.hpp), model size and memory (see memory.hpp)
+            if (state.runtime > 0)
+                cout << "; total runtime = " << cb->totalRuntime(model.get(GRB_DoubleAttr_Runtime)) << " sec"; //< with the runs it resumes
+            cout << endl;
 
             if (verbose)
             {
-                int i = 0;
-                int k = 0;
-                for (size_t j = 0; j < n; ++j)
+                vector<int> succ(n, -1);
+                for (int a = 0; a < g.m; ++a)
                 {
-                    if (k == n)
-                        break;
-                    if (i != j && (i == 0 || k != 0) && (i != 0 || k == 0) && (j == 0 || k != n - 1) && (j != 0 || k == n - 1))
+                    for (int k = 0; k < n; ++k)
                     {
-                        if (x[i][j][k].get(GRB_DoubleAttr_X) >= 0.5)
-                        {
-                            cout << "ville " << i << " --> "
-                                 << "ville " << j << endl;
-                            i = j;
-                            if (i == 0)
-                                break;
-                            j = -1;
-                            k++;
-                        }
+                        if (flotArc(g.tail[a], g.head[a], k, n) && x[a][k].get(GRB_DoubleAttr_X) >= 0.5)
+                            succ[g.tail[a]] = g.head[a];
                     }
                 }
+                int i = 0;
+                for (int k = 0; k < n && succ[i] >= 0; ++k)
+                {
+                    cout << "ville " << cb->city(i) << " --> "
+                         << "ville " << cb->city(succ[i]) << endl;
+                    i = succ[i];
+                    if (i == 0)
+                        break;
+                }
             }
             // model.write("solution.sol"); //< Writes the solution in a file
         }
@@ -305,6 +362,7 @@ int main(int argc,
             // the model is infeasible (maybe wrong) or the solver has reached the time limit without finding a feasible solution
             cerr << "Fail! (Status: " << status << ")" << endl; //< see status page in the Gurobi documentation
         }
+        delete cb;
     }
     catch (GRBException e)
     {
@@ -316,11 +374,9 @@ int main(int argc,
         cout << "Exception during optimization" << endl;
     }
 
-    for (size_t j = 0; j < n; ++j)
+    for (int a = 0; x != nullptr && a < g.m; ++a)
     {
-        for (size_t i = 0; i < n; ++i)
-            delete[] x[j][i];
-        delete[] x[j];
+        delete[] x[a];
     }
     delete[] x;
 
@@ -0,0 +1,197 @@
+#include "parser.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Writes a synthetic ATSP instance in the format of TSP_data (TSPLIB FULL_MATRIX).
+// Every row is computed from a generator seeded with (seed, row), then written
+// and forgotten: only O(n) data (the coordinates) stays in memory, so that a
+// 10k cities matrix never has to be held at once.
+//
+// usage : ./gen.out <FAMILY> <N> <SEED> <OUTPUT_FILE> [--max-cost=1000] [--clusters=10] [--noise=0.3]
+//
+// families:
+//   uniform    independent costs drawn in [1, max-cost]
+//   clustered  cities around a few centers, euclidean distance plus asymmetric noise
+//   euclidean  uniform cities in a square, euclidean distance plus asymmetric noise
+//   ftv        Fischetti-like: manhattan street distances plus an asymmetric "uphill"
+//              surcharge, which keeps the triangle inequality as in the ftv instances
+
+struct Options
+{
+    string family;
+    int n;
+    unsigned seed;
+    int maxCost;
+    int clusters;
+    double noise;
+};
+
+struct City
+{
+    double x, y, height;
+};
+
+static mt19937_64 rowGenerator(unsigned seed, int row)
+{
+    seed_seq sequence = {seed, (unsigned)row, 0x7459u};
+    return mt19937_64(sequence);
+}
+
+// coordinates are drawn once from the row -1 stream
+static vector<City> cities(const Options &options)
+{
+    mt19937_64 rng = rowGenerator(options.seed, -1);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    vector<City> cities(options.n);
+    double side = options.maxCost / 2.0;
+
+    vector<City> centers(max(1, options.clusters));
+    for (City &center : centers)
+    {
+        center.x = unit(rng) * side;
+        center.y = unit(rng) * side;
+    }
+    normal_distribution<double> spread(0.0, side / (4.0 * sqrt((double)centers.size())));
+
+    for (City &city : cities)
+    {
+        if (options.family == "clustered")
+        {
+            const City &center = centers[rng() % centers.size()];
+            city.x = center.x + spread(rng);
+            city.y = center.y + spread(rng);
+        }
+        else
+        {
+            city.x = unit(rng) * side;
+            city.y = unit(rng) * side;
+        }
+        city.height = unit(rng) * side * options.noise;
+    }
+    return cities;
+}
+
+static void computeRow(const Options &options, const vector<City> &cities, int i, vector<int> &row)
+{
+    mt19937_64 rng = rowGenerator(options.seed, i);
+    uniform_int_distribution<int> cost(1, options.maxCost);
+    uniform_real_distribution<double> noise(0.0, options.noise);
+
+    for (int j = 0; j < options.n; ++j)
+    {
+        if (options.family == "uniform")
+        {
+            row[j] = cost(rng);
+        }
+        else if (options.family == "ftv")
+        {
+            double street = fabs(cities[i].x - cities[j].x) + fabs(cities[i].y - cities[j].y);
+            double uphill = max(0.0, cities[j].height - cities[i].height);
+            row[j] = 1 + (int)lround(street + uphill);
+        }
+        else
+        {
+            double distance = hypot(cities[i].x - cities[j].x, cities[i].y - cities[j].y);
+            row[j] = 1 + (int)lround(distance * (1.0 + noise(rng)));
+        }
+    }
+    row[i] = forbiddenCost;
+}
+
+static bool option(const char *arg, const char *name, string &value)
+{
+    size_t length = strlen(name);
+    if (strncmp(arg, name, length) != 0 || arg[length] != '=')
+        return false;
+    value = arg + length + 1;
+    return true;
+}
+
+int main(int argc,
+         char *argv[])
+{
+    if (argc < 5)
+    {
+        cerr << "usage : " << argv[0] << " <uniform|clustered|euclidean|ftv> <N> <SEED> <OUTPUT_FILE> [--max-cost=1000] [--clusters=10] [--noise=0.3]" << endl;
+        return 1;
+    }
+    Options options;
+    options.family = argv[1];
+    options.n = atoi(argv[2]);
+    options.seed = strtoul(argv[3], nullptr, 10);
+    options.maxCost = 1000;
+    options.clusters = 10;
+    options.noise = 0.3;
+    for (int a = 5; a < argc; ++a)
+    {
+        string value;
+        if (option(argv[a], "--max-cost", value))
+            options.maxCost = atoi(value.c_str());
+        else if (option(argv[a], "--clusters", value))
+            options.clusters = atoi(value.c_str());
+        else if (option(argv[a], "--noise", value))
+            options.noise = atof(value.c_str());
+        else
+        {
+            cerr << "Unknown option " << argv[a] << endl;
+            return 1;
+        }
+    }
+    if (options.family != "uniform" && options.family != "clustered" && options.family != "euclidean" && options.family != "ftv")
+    {
+        cerr << "Unknown family " << options.family << endl;
+        return 1;
+    }
+    if (options.n < 2 || options.maxCost < 1)
+    {
+        cerr << "Invalid size or cost range" << endl;
+        return 1;
+    }
+
+    ofstream file(argv[4]);
+    if (!file.is_open())
+    {
+        cerr << "File open failed\n"
+             << endl;
+        return 1;
+    }
+
+    // the parser skips these 7 lines
+    string name = options.family + to_string(options.n) + "_" + to_string(options.seed);
+    file << "NAME: " << name << "\n";
+    file << "TYPE: ATSP\n";
+    file << "COMMENT: Synthetic " << options.family << " instance (seed " << options.seed << ")\n";
+    file << "DIMENSION: " << options.n << "\n";
+    file << "EDGE_WEIGHT_TYPE: EXPLICIT\n";
+    file << "EDGE_WEIGHT_FORMAT: FULL_MATRIX \n";
+    file << "EDGE_WEIGHT_SECTION\n";
+
+    vector<City> coordinates = cities(options);
+    vector<int> row(options.n);
+    string line;
+    for (int i = 0; i < options.n; ++i)
+    {
+        computeRow(options, coordinates, i, row);
+        line.clear();
+        for (int j = 0; j < options.n; ++j)
+        {
+            line += to_string(row[j]);
+            line += ' ';
+        }
+        line += '\n';
+        file << line;
+    }
+    if (!file)
+    {
+        cerr << "Write failed" << endl;
+        return 1;
+    }
+    return 0;
+}
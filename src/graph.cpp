@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include "assignment.hpp"
+#include "graph.hpp"
+#include "heuristic.hpp"
+#include "parser.hpp"
+#include "tour.hpp"
+
+int Graph::arc(int i, int j) const
+{
+    std::vector<int>::const_iterator first = head.begin() + outStart[i];
+    std::vector<int>::const_iterator last = head.begin() + outStart[i + 1];
+    std::vector<int>::const_iterator it = std::lower_bound(first, last, j);
+    if (it == last || *it != j)
+        return -1;
+    return it - head.begin();
+}
+
+// fills the graph from a sorted, duplicate-free list of arcs
+static void fill(Graph &g, const std::vector<std::vector<int>> &c, const std::vector<std::pair<int, int>> &arcs)
+{
+    g.m = arcs.size();
+    g.tail.resize(g.m);
+    g.head.resize(g.m);
+    g.cost.resize(g.m);
+    g.outStart.assign(g.n + 1, 0);
+    g.inStart.assign(g.n + 1, 0);
+    for (int a = 0; a < g.m; ++a)
+    {
+        g.tail[a] = arcs[a].first;
+        g.head[a] = arcs[a].second;
+        g.cost[a] = c[g.tail[a]][g.head[a]];
+        g.outStart[g.tail[a] + 1]++;
+        g.inStart[g.head[a] + 1]++;
+    }
+    for (int i = 0; i < g.n; ++i)
+    {
+        g.outStart[i + 1] += g.outStart[i];
+        g.inStart[i + 1] += g.inStart[i];
+    }
+    g.inArc.resize(g.m);
+    std::vector<int> next(g.inStart.begin(), g.inStart.end() - 1);
+    for (int a = 0; a < g.m; ++a)
+        g.inArc[next[g.head[a]]++] = a;
+}
+
+Graph buildGraph(const std::vector<std::vector<int>> &c, bool reduce, long long slack, const std::vector<std::pair<int, int>> &extra)
+{
+    Graph g;
+    g.n = c.size();
+    g.forbidden = 0;
+    g.dominated = 0;
+    g.lowerBound = 0;
+    g.upperBound = 0;
+
+    Assignment ap;
+    if (reduce && g.n > 2)
+    {
+        ap = solveAssignment(c);
+        g.lowerBound = ap.cost;
+        std::vector<int> succ = ap.succ;
+        patchCycles(c, succ);
+        orOpt(c, succ);
+        g.upperBound = successorCost(c, succ);
+        // a tour through a forbidden arc proves nothing
+        if (g.upperBound >= forbiddenCost)
+            reduce = false;
+    }
+    else
+    {
+        reduce = false;
+    }
+
+    std::vector<std::vector<char>> kept(g.n, std::vector<char>(g.n, 0));
+    for (const std::pair<int, int> &a : extra)
+    {
+        if (a.first != a.second)
+            kept[a.first][a.second] = 1;
+    }
+    std::vector<std::pair<int, int>> arcs;
+    for (int i = 0; i < g.n; ++i)
+    {
+        for (int j = 0; j < g.n; ++j)
+        {
+            if (kept[i][j])
+                arcs.push_back(std::make_pair(i, j));
+            else if (i == j || c[i][j] >= forbiddenCost)
+                g.forbidden++;
+            else if (reduce && g.lowerBound + ap.reducedCost(c, i, j) > g.upperBound + slack)
+                g.dominated++;
+            else
+                arcs.push_back(std::make_pair(i, j));
+        }
+    }
+    fill(g, c, arcs);
+    return g;
+}
+
+Graph restrictGraph(const std::vector<std::vector<int>> &c, const std::vector<std::pair<int, int>> &arcs)
+{
+    Graph g;
+    g.n = c.size();
+    g.lowerBound = 0;
+    g.upperBound = 0;
+    g.forbidden = 0;
+    for (int i = 0; i < g.n; ++i)
+        for (int j = 0; j < g.n; ++j)
+            if (i == j || c[i][j] >= forbiddenCost)
+                g.forbidden++;
+
+    std::vector<std::pair<int, int>> kept;
+    for (const std::pair<int, int> &a : arcs)
+    {
+        if (a.first != a.second && c[a.first][a.second] < forbiddenCost)
+            kept.push_back(a);
+    }
+    std::sort(kept.begin(), kept.end());
+    kept.erase(std::unique(kept.begin(), kept.end()), kept.end());
+    g.dominated = g.n * g.n - g.forbidden - kept.size();
+    fill(g, c, kept);
+    return g;
+}
+
+void printReport(const Graph &g)
+{
+    std::cout << "--> Sparse graph: " << g.m << " arcs kept, "
+              << g.forbidden << " forbidden and " << g.dominated << " dominated arcs removed";
+    if (g.upperBound > 0)
+        std::cout << " (assignment bound " << g.lowerBound << ", heuristic tour " << g.upperBound << ")";
+    std::cout << std::endl;
+}
+
+std::vector<int> arcSuccessors(const Graph &g, const std::vector<double> &value, bool symmetric)
+{
+    int n = g.n;
+    std::vector<std::vector<int>> neighbours(n);
+    for (int a = 0; a < g.m; ++a)
+    {
+        if (value[a] >= 0.5)
+        {
+            neighbours[g.tail[a]].push_back(g.head[a]);
+            if (symmetric)
+                neighbours[g.head[a]].push_back(g.tail[a]);
+        }
+    }
+    std::vector<int> succ(n, -1);
+    int previous = -1;
+    int i = 0;
+    for (int step = 0; step < n && !neighbours[i].empty(); ++step)
+    {
+        int j = neighbours[i][0] != previous || neighbours[i].size() == 1 ? neighbours[i][0] : neighbours[i][1];
+        succ[i] = j;
+        previous = i;
+        i = j;
+        if (i == 0)
+            break;
+    }
+    return succ;
+}
+
+std::vector<std::vector<int>> shortCycles(const std::vector<std::vector<int>> &c, const Graph &g, bool symmetric, int triangles, int neighbours)
+{
+    int n = g.n;
+    std::vector<std::vector<int>> sets;
+    if (!symmetric)
+    {
+        for (int a = 0; a < g.m; ++a)
+        {
+            if (g.tail[a] < g.head[a] && g.arc(g.head[a], g.tail[a]) >= 0)
+                sets.push_back({g.tail[a], g.head[a]});
+        }
+    }
+    if (triangles <= 0 || n < 4)
+        return sets;
+
+    Assignment assignment = solveAssignment(c);
+    // the edges of the symmetric graph are stored with tail < head
+    auto linked = [&](int i, int j) {
+        return symmetric ? g.arc(std::min(i, j), std::max(i, j)) >= 0 : g.arc(i, j) >= 0;
+    };
+    std::vector<std::vector<std::pair<long long, int>>> adjacent(n);
+    for (int a = 0; a < g.m; ++a)
+    {
+        int i = g.tail[a], j = g.head[a];
+        adjacent[i].push_back(std::make_pair(assignment.reducedCost(c, i, j), j));
+        if (symmetric)
+            adjacent[j].push_back(std::make_pair(assignment.reducedCost(c, j, i), i));
+    }
+
+    // cheapest orientation i -> j -> k -> i of each triangle
+    std::map<std::vector<int>, long long> candidates;
+    for (int i = 0; i < n; ++i)
+    {
+        std::vector<std::pair<long long, int>> &near = adjacent[i];
+        std::sort(near.begin(), near.end());
+        if ((int)near.size() > neighbours)
+            near.resize(neighbours);
+        for (const std::pair<long long, int> &first : near)
+        {
+            for (const std::pair<long long, int> &second : near)
+            {
+                int j = first.second, k = second.second;
+                if (j == k || !linked(j, k) || !linked(k, i))
+                    continue;
+                long long score = first.first + assignment.reducedCost(c, j, k) + assignment.reducedCost(c, k, i);
+                std::vector<int> S = {i, j, k};
+                std::sort(S.begin(), S.end());
+                std::map<std::vector<int>, long long>::iterator it = candidates.find(S);
+                if (it == candidates.end())
+                    candidates[S] = score;
+                else
+                    it->second = std::min(it->second, score);
+            }
+        }
+    }
+
+    std::vector<std::pair<long long, std::vector<int>>> sorted;
+    for (const std::pair<const std::vector<int>, long long> &candidate : candidates)
+        sorted.push_back(std::make_pair(candidate.second, candidate.first));
+    std::stable_sort(sorted.begin(), sorted.end());
+    for (int k = 0; k < triangles && k < (int)sorted.size(); ++k)
+        sets.push_back(sorted[k].second);
+    return sets;
+}
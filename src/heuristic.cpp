@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "assignment.hpp"
+#include "heuristic.hpp"
+#include "parser.hpp"
+#include "tour.hpp"
+
+std::vector<int> nearestNeighbour(const std::vector<std::vector<int>> &c, int start)
+{
+    int n = c.size();
+    std::vector<int> succ(n, -1);
+    std::vector<char> visited(n, 0);
+    int i = start;
+    visited[i] = 1;
+    for (int step = 1; step < n; ++step)
+    {
+        int best = -1;
+        for (int j = 0; j < n; ++j)
+        {
+            if (!visited[j] && (best < 0 || c[i][j] < c[i][best]))
+                best = j;
+        }
+        succ[i] = best;
+        visited[best] = 1;
+        i = best;
+    }
+    succ[i] = start;
+    return succ;
+}
+
+void patchCycles(const std::vector<std::vector<int>> &c, std::vector<int> &succ)
+{
+    std::vector<std::vector<int>> all = cycles(succ);
+    if (all.size() <= 1)
+        return;
+    // the largest cycle absorbs the others one by one, smallest first
+    std::sort(all.begin(), all.end(), [](const std::vector<int> &a, const std::vector<int> &b) { return a.size() > b.size(); });
+    std::vector<int> tour = all[0];
+    for (size_t k = all.size() - 1; k >= 1; --k)
+    {
+        const std::vector<int> &other = all[k];
+        long long best = std::numeric_limits<long long>::max();
+        int bestA = -1, bestB = -1;
+        for (int a : tour)
+        {
+            const std::vector<int> &row = c[a];
+            int sa = succ[a];
+            long long base = -(long long)row[sa];
+            for (int b : other)
+            {
+                int sb = succ[b];
+                long long delta = base + row[sb] + c[b][sa] - c[b][sb];
+                if (delta < best)
+                {
+                    best = delta;
+                    bestA = a;
+                    bestB = b;
+                }
+            }
+        }
+        std::swap(succ[bestA], succ[bestB]);
+        tour.insert(tour.end(), other.begin(), other.end());
+    }
+}
+
+std::vector<int> patchRelaxation(const std::vector<std::vector<int>> &c, const std::vector<double> &x)
+{
+    int n = c.size();
+    // the larger the value of an arc, the cheaper it is to round to
+    std::vector<std::vector<int>> rounded(c);
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            double value = std::min(std::max(x[(size_t)i * n + j], 0.0), 1.0);
+            if (c[i][j] < forbiddenCost)
+                rounded[i][j] = (int)std::lround(c[i][j] * (1 - value));
+        }
+    }
+    std::vector<int> succ = solveAssignment(rounded).succ;
+    patchCycles(c, succ);
+    orOpt(c, succ);
+    for (int i = 0; i < n; ++i)
+    {
+        if (c[i][succ[i]] >= forbiddenCost)
+            return std::vector<int>();
+    }
+    return succ;
+}
+
+bool orOpt(const std::vector<std::vector<int>> &c, std::vector<int> &succ, int maxSegment)
+{
+    std::vector<int> pred;
+    return orOpt(c, succ, maxSegment, pred);
+}
+
+bool orOpt(const std::vector<std::vector<int>> &c, std::vector<int> &succ, int maxSegment, std::vector<int> &pred)
+{
+    int n = succ.size();
+    if (n < 5)
+        return false;
+    pred.resize(n);
+    for (int i = 0; i < n; ++i)
+        pred[succ[i]] = i;
+
+    bool improved = false, improving = true;
+    while (improving)
+    {
+        improving = false;
+        for (int s = 0; s < n; ++s)
+        {
+            int e = s;
+            bool moved = false;
+            for (int length = 1; length <= maxSegment && length <= n - 3 && !moved; ++length, e = succ[e])
+            {
+                // the segment s..e is removed from p -> s ... e -> q
+                int p = pred[s], q = succ[e];
+                long long removal = (long long)c[p][q] - c[p][s] - c[e][q];
+                // and inserted between a and b = succ(a), a running over the rest of the tour
+                for (int a = q; a != p; a = succ[a])
+                {
+                    int b = succ[a];
+                    if (removal + c[a][s] + c[e][b] - c[a][b] < 0)
+                    {
+                        succ[p] = q;
+                        pred[q] = p;
+                        succ[a] = s;
+                        pred[s] = a;
+                        succ[e] = b;
+                        pred[b] = e;
+                        improved = improving = moved = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return improved;
+}
+
+void randomNearestNeighbour(const std::vector<std::vector<int>> &c, std::mt19937_64 &rng, int candidates, std::vector<int> &succ, std::vector<char> &visited)
+{
+    int n = c.size();
+    succ.assign(n, -1);
+    visited.assign(n, 0);
+    int start = rng() % n;
+    int i = start;
+    visited[i] = 1;
+    std::vector<int> best(candidates); // the cheapest unvisited cities, in increasing cost
+    for (int step = 1; step < n; ++step)
+    {
+        int found = 0;
+        const std::vector<int> &row = c[i];
+        for (int j = 0; j < n; ++j)
+        {
+            if (visited[j] || (found == candidates && row[j] >= row[best[found - 1]]))
+                continue;
+            int k = found < candidates ? found++ : found - 1;
+            while (k > 0 && row[best[k - 1]] > row[j])
+            {
+                best[k] = best[k - 1];
+                k--;
+            }
+            best[k] = j;
+        }
+        int rank = 0;
+        while (rank + 1 < found && (rng() & 1))
+            rank++;
+        succ[i] = best[rank];
+        visited[best[rank]] = 1;
+        i = best[rank];
+    }
+    succ[i] = start;
+}
+
+void doubleBridge(std::vector<int> &succ, std::mt19937_64 &rng, std::vector<int> &tour)
+{
+    int n = succ.size();
+    if (n < 8)
+        return;
+    tour.resize(n);
+    int i = 0;
+    for (int k = 0; k < n; ++k, i = succ[i])
+        tour[k] = i;
+    // three cut points 0 < p1 < p2 < p3 < n
+    int cut[3];
+    do
+    {
+        for (int k = 0; k < 3; ++k)
+            cut[k] = 1 + rng() % (n - 1);
+        std::sort(cut, cut + 3);
+    } while (cut[0] == cut[1] || cut[1] == cut[2]);
+    int a = tour[cut[0] - 1], b = tour[cut[0]];     // A ends at a, B starts at b
+    int bEnd = tour[cut[1] - 1], c0 = tour[cut[1]]; // B ends at bEnd, C starts at c0
+    int cEnd = tour[cut[2] - 1], d = tour[cut[2]];  // C ends at cEnd, D starts at d
+    succ[a] = c0;
+    succ[cEnd] = b;
+    succ[bEnd] = d;
+}
@@ -0,0 +1,81 @@
+#include "config.hpp"
+#include "multistart.hpp"
+#include "parser.hpp"
+#include "relabel.hpp"
+#include "tour.hpp"
+#include <chrono>
+#include <iostream>
+using namespace std;
+
+// Heuristic solver: multi-start randomised constructions and local search on
+// every core (see multistart.hpp). It gives no optimality proof but a good tour
+// within the time limit; its Result line has the format of the models, so that
+// benchmark.sh and compare.out work on it too.
+//
+// usage : ./heuristic.out <PATH_TO_DAT_FILE> [-nv] [--time-limit=10] [--threads=N] [--starts=N] [--seed=1] [--candidates=3] [--relabel]
+
+int main(int argc,
+         char *argv[])
+{
+    Config config = parseArgs(argc, argv, 10.0);
+    bool verbose = config.verbose;
+
+    // parse and save the data
+    vector<vector<int>> c = parse(argv[1]);
+    int n = c.size();
+
+    // --relabel: the search runs on the cities numbered along a heuristic tour (see relabel.hpp)
+    Relabelling relabelling;
+    double relabelSeconds = 0;
+    if (config.has("relabel"))
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        relabelling = localityRelabelling(c);
+        c = relabelMatrix(c, relabelling);
+        relabelSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+
+    MultiStartOptions options;
+    options.threads = config.threads;
+    options.starts = (long)config.number("starts", 0);
+    options.timeLimit = config.timeLimit;
+    options.seed = (unsigned)config.number("seed", 1);
+    options.candidates = (int)config.number("candidates", 3);
+    options.keep = 0;
+    if (verbose)
+        cout << "--> Multi-start heuristic on " << options.threads << " threads" << endl;
+
+    MultiStartResult result = multiStart(c, options);
+    if (result.succ.empty())
+    {
+        cerr << "Fail! (no start completed)" << endl;
+        return 0;
+    }
+
+    if (config.has("relabel"))
+        result.succ = originalSuccessors(result.succ, relabelling);
+
+    cout << "Result: ";
+    cout << argv[1] << "; ";
+    cout << "runtime = " << result.seconds << " sec; ";
+    cout << "objective value = " << result.cost << "; ";
+    cout << "starts = " << result.starts << "; ";
+    cout << "starts per second = " << result.starts / result.seconds << "; ";
+    cout << "improvements = " << result.improvements << "; ";
+    cout << "steals = " << result.steals << "; ";
+    cout << "threads = " << options.threads;
+    if (config.has("relabel"))
+        cout << "; relabelling = " << relabelSeconds << " sec";
+    cout << endl;
+
+    if (verbose)
+    {
+        for (int i = 0, step = 0; step < n; ++step)
+        {
+            cout << "ville " << i << " --> "
+                 << "ville " << result.succ[i] << endl;
+            i = result.succ[i];
+        }
+    }
+    return 0;
+}
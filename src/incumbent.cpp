@@ -0,0 +1,77 @@
+#include <iostream>
+#include <sstream>
+#include "incumbent.hpp"
+
+IncumbentStream::IncumbentStream(std::string filePath, size_t _capacity)
+    : out(&std::cout), capacity(_capacity > 0 ? _capacity : 1), stopping(false), writes(0), drops(0)
+{
+    if (filePath != "-")
+    {
+        file.open(filePath);
+        out = &file;
+    }
+    writer = std::thread(&IncumbentStream::run, this);
+}
+
+IncumbentStream::~IncumbentStream()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    ready.notify_one();
+    writer.join();
+}
+
+bool IncumbentStream::ok() const
+{
+    return out != &file || file.is_open();
+}
+
+void IncumbentStream::push(Incumbent incumbent)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (queue.size() >= capacity)
+        {
+            queue.pop_front();
+            drops++;
+        }
+        queue.push_back(std::move(incumbent));
+    }
+    ready.notify_one();
+}
+
+long IncumbentStream::written() const
+{
+    return writes;
+}
+
+long IncumbentStream::dropped() const
+{
+    return drops;
+}
+
+void IncumbentStream::run()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    while (true)
+    {
+        ready.wait(guard, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty())
+            return; //< stopping, everything written
+        Incumbent incumbent = std::move(queue.front());
+        queue.pop_front();
+        guard.unlock();
+
+        std::stringstream line;
+        line << "{\"time\":" << incumbent.time << ",\"objective\":" << incumbent.objective << ",\"bound\":" << incumbent.bound << ",\"succ\":[";
+        for (size_t i = 0; i < incumbent.succ.size(); ++i)
+            line << (i ? "," : "") << incumbent.succ[i];
+        line << "]}\n";
+        *out << line.str() << std::flush;
+        writes++;
+
+        guard.lock();
+    }
+}
@@ -0,0 +1,232 @@
+#include <cstdio>
+#include <cstdlib>
+#include "json.hpp"
+
+JsonValue::JsonValue() : type(NUL), boolean(false), number(0) {}
+
+bool JsonValue::has(std::string key) const
+{
+    return type == OBJECT && members.count(key) > 0;
+}
+
+const JsonValue &JsonValue::operator[](std::string key) const
+{
+    static const JsonValue null;
+    std::map<std::string, JsonValue>::const_iterator it = members.find(key);
+    return type != OBJECT || it == members.end() ? null : it->second;
+}
+
+namespace
+{
+    // recursive descent over the text, pos being the next character to read
+    class JsonReader
+    {
+    public:
+        JsonReader(const std::string &_text) : text(_text), pos(0) {}
+
+        bool document(JsonValue &value, std::string &error)
+        {
+            if (!read(value, 0))
+            {
+                error = message.empty() ? "invalid JSON" : message;
+                return false;
+            }
+            skip();
+            if (pos != text.size())
+            {
+                error = "trailing characters at " + std::to_string(pos);
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        const std::string &text;
+        size_t pos;
+        std::string message;
+
+        void skip()
+        {
+            while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n'))
+                pos++;
+        }
+
+        bool fail(std::string what)
+        {
+            message = what + " at " + std::to_string(pos);
+            return false;
+        }
+
+        bool literal(const char *word)
+        {
+            size_t length = std::string(word).size();
+            if (text.compare(pos, length, word) != 0)
+                return fail("unexpected character");
+            pos += length;
+            return true;
+        }
+
+        bool string(std::string &s)
+        {
+            pos++; // opening quote
+            while (pos < text.size() && text[pos] != '"')
+            {
+                char ch = text[pos++];
+                if (ch != '\\')
+                {
+                    s += ch;
+                    continue;
+                }
+                if (pos >= text.size())
+                    break;
+                char escaped = text[pos++];
+                switch (escaped)
+                {
+                case 'n': s += '\n'; break;
+                case 't': s += '\t'; break;
+                case 'r': s += '\r'; break;
+                case 'b': s += '\b'; break;
+                case 'f': s += '\f'; break;
+                case 'u':
+                {
+                    // only the ASCII range is needed by the protocol
+                    if (pos + 4 > text.size())
+                        return fail("truncated escape");
+                    long code = strtol(text.substr(pos, 4).c_str(), nullptr, 16);
+                    s += code < 128 ? (char)code : '?';
+                    pos += 4;
+                    break;
+                }
+                default: s += escaped;
+                }
+            }
+            if (pos >= text.size())
+                return fail("unterminated string");
+            pos++; // closing quote
+            return true;
+        }
+
+        bool read(JsonValue &value, int depth)
+        {
+            if (depth > 64)
+                return fail("nesting too deep");
+            skip();
+            if (pos >= text.size())
+                return fail("unexpected end");
+            char ch = text[pos];
+            if (ch == '{')
+            {
+                value.type = JsonValue::OBJECT;
+                pos++;
+                skip();
+                if (pos < text.size() && text[pos] == '}')
+                {
+                    pos++;
+                    return true;
+                }
+                while (true)
+                {
+                    skip();
+                    std::string key;
+                    if (pos >= text.size() || text[pos] != '"' || !string(key))
+                        return fail("expected a key");
+                    skip();
+                    if (pos >= text.size() || text[pos] != ':')
+                        return fail("expected ':'");
+                    pos++;
+                    if (!read(value.members[key], depth + 1))
+                        return false;
+                    skip();
+                    if (pos < text.size() && text[pos] == ',')
+                        pos++;
+                    else if (pos < text.size() && text[pos] == '}')
+                    {
+                        pos++;
+                        return true;
+                    }
+                    else
+                        return fail("expected ',' or '}'");
+                }
+            }
+            if (ch == '[')
+            {
+                value.type = JsonValue::ARRAY;
+                pos++;
+                skip();
+                if (pos < text.size() && text[pos] == ']')
+                {
+                    pos++;
+                    return true;
+                }
+                while (true)
+                {
+                    value.items.push_back(JsonValue());
+                    if (!read(value.items.back(), depth + 1))
+                        return false;
+                    skip();
+                    if (pos < text.size() && text[pos] == ',')
+                        pos++;
+                    else if (pos < text.size() && text[pos] == ']')
+                    {
+                        pos++;
+                        return true;
+                    }
+                    else
+                        return fail("expected ',' or ']'");
+                }
+            }
+            if (ch == '"')
+            {
+                value.type = JsonValue::STRING;
+                return string(value.text);
+            }
+            if (ch == 't' || ch == 'f')
+            {
+                value.type = JsonValue::BOOLEAN;
+                value.boolean = ch == 't';
+                return literal(ch == 't' ? "true" : "false");
+            }
+            if (ch == 'n')
+                return literal("null");
+            const char *start = text.c_str() + pos;
+            char *end = nullptr;
+            value.number = strtod(start, &end);
+            if (end == start)
+                return fail("unexpected character");
+            value.type = JsonValue::NUMBER;
+            pos += end - start;
+            return true;
+        }
+    };
+}
+
+bool parseJson(const std::string &text, JsonValue &value, std::string &error)
+{
+    value = JsonValue();
+    JsonReader reader(text);
+    return reader.document(value, error);
+}
+
+std::string jsonString(const std::string &s)
+{
+    std::string quoted = "\"";
+    for (char ch : s)
+    {
+        if (ch == '"' || ch == '\\')
+        {
+            quoted += '\\';
+            quoted += ch;
+        }
+        else if (ch == '\n')
+            quoted += "\\n";
+        else if ((unsigned char)ch < 0x20)
+        {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", ch);
+            quoted += code;
+        }
+        else
+            quoted += ch;
+    }
+    return quoted + "\"";
+}
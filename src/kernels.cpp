@@ -0,0 +1,373 @@
+#include <climits>
+#include "kernels.hpp"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define KERNELS_X86
+#include <immintrin.h>
+#endif
+
+CostMatrix::CostMatrix(const std::vector<std::vector<int>> &c)
+{
+    n = c.size();
+    stride = (n + 15) / 16 * 16;
+    data.assign((size_t)n * stride, 0);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            data[(size_t)i * stride + j] = c[i][j];
+}
+
+struct KernelTable
+{
+    long long (*tourCost)(const CostMatrix &c, const int *tour, int n);
+    void (*insertionDeltas)(const CostMatrix &c, const int *tour, int n, int first, int last, int *delta);
+    void (*bestSuccessors)(const CostMatrix &c, const int *cities, int count, int *best);
+    void (*bestPredecessors)(const CostMatrix &c, const int *cities, int count, int *best, int *value);
+};
+
+// --- scalar ---
+
+static long long tourCostScalar(const CostMatrix &c, const int *tour, int n)
+{
+    long long cost = 0;
+    for (int k = 0; k + 1 < n; ++k)
+        cost += c.row(tour[k])[tour[k + 1]];
+    return cost + c.row(tour[n - 1])[tour[0]];
+}
+
+// the arcs from k on, the vectorised versions doing the first ones
+static void insertionDeltasFrom(const CostMatrix &c, const int *tour, int n, int first, int last, int *delta, int k)
+{
+    const int *toFirst = c.data.data() + first;
+    const int *fromLast = c.row(last);
+    for (; k < n; ++k)
+    {
+        int a = tour[k], b = tour[k + 1 < n ? k + 1 : 0];
+        delta[k] = toFirst[(size_t)a * c.stride] + fromLast[b] - c.row(a)[b];
+    }
+}
+
+static void insertionDeltasScalar(const CostMatrix &c, const int *tour, int n, int first, int last, int *delta)
+{
+    insertionDeltasFrom(c, tour, n, first, last, delta, 0);
+}
+
+// cheapest j != i of the row from j on, better than (value, best)
+static void rowMinimumFrom(const int *row, int n, int i, int j, int &value, int &best)
+{
+    for (; j < n; ++j)
+    {
+        if (j != i && row[j] < value)
+        {
+            value = row[j];
+            best = j;
+        }
+    }
+}
+
+static void bestSuccessorsScalar(const CostMatrix &c, const int *cities, int count, int *best)
+{
+    for (int k = 0; k < count; ++k)
+    {
+        int value = INT_MAX;
+        best[k] = -1;
+        rowMinimumFrom(c.row(cities[k]), c.n, cities[k], 0, value, best[k]);
+    }
+}
+
+// the rows are swept in order, each updating every city of the batch: the
+// scan reads whole rows instead of one column per city
+static void columnMinimumFrom(const int *row, int j, const int *cities, int count, int *best, int *value, int k)
+{
+    for (; k < count; ++k)
+    {
+        int v = row[cities[k]];
+        if (cities[k] != j && v < value[k])
+        {
+            value[k] = v;
+            best[k] = j;
+        }
+    }
+}
+
+static void bestPredecessorsScalar(const CostMatrix &c, const int *cities, int count, int *best, int *value)
+{
+    for (int j = 0; j < c.n; ++j)
+        columnMinimumFrom(c.row(j), j, cities, count, best, value, 0);
+}
+
+static const KernelTable scalarTable = {tourCostScalar, insertionDeltasScalar, bestSuccessorsScalar, bestPredecessorsScalar};
+
+#ifdef KERNELS_X86
+
+// --- AVX2: 8 lanes ---
+
+__attribute__((target("avx2"))) static long long tourCostAvx2(const CostMatrix &c, const int *tour, int n)
+{
+    const __m256i stride = _mm256_set1_epi32(c.stride);
+    __m256i sum = _mm256_setzero_si256();
+    int k = 0;
+    for (; k + 8 < n; k += 8)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(tour + k));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(tour + k + 1));
+        __m256i cost = _mm256_i32gather_epi32(c.data.data(), _mm256_add_epi32(_mm256_mullo_epi32(a, stride), b), 4);
+        // summed on 64 bits: the closed arcs cost 100000000
+        sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(cost)));
+        sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(cost, 1)));
+    }
+    long long lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, sum);
+    long long cost = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; k + 1 < n; ++k)
+        cost += c.row(tour[k])[tour[k + 1]];
+    return cost + c.row(tour[n - 1])[tour[0]];
+}
+
+__attribute__((target("avx2"))) static void insertionDeltasAvx2(const CostMatrix &c, const int *tour, int n, int first, int last, int *delta)
+{
+    const __m256i stride = _mm256_set1_epi32(c.stride);
+    const __m256i toFirst = _mm256_set1_epi32(first);
+    const __m256i fromLast = _mm256_set1_epi32(last * c.stride);
+    int k = 0;
+    for (; k + 8 < n; k += 8)
+    {
+        __m256i a = _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(tour + k)), stride);
+        __m256i b = _mm256_loadu_si256((const __m256i *)(tour + k + 1));
+        __m256i in = _mm256_i32gather_epi32(c.data.data(), _mm256_add_epi32(a, toFirst), 4);
+        __m256i out = _mm256_i32gather_epi32(c.data.data(), _mm256_add_epi32(fromLast, b), 4);
+        __m256i removed = _mm256_i32gather_epi32(c.data.data(), _mm256_add_epi32(a, b), 4);
+        _mm256_storeu_si256((__m256i *)(delta + k), _mm256_sub_epi32(_mm256_add_epi32(in, out), removed));
+    }
+    insertionDeltasFrom(c, tour, n, first, last, delta, k);
+}
+
+// smallest value of the lanes, the smallest index among equal values
+static void reduceMinimum(const int *values, const int *indices, int lanes, int &value, int &best)
+{
+    for (int l = 0; l < lanes; ++l)
+    {
+        if (indices[l] >= 0 && (values[l] < value || (values[l] == value && indices[l] < best)))
+        {
+            value = values[l];
+            best = indices[l];
+        }
+    }
+}
+
+__attribute__((target("avx2"))) static void bestSuccessorsAvx2(const CostMatrix &c, const int *cities, int count, int *best)
+{
+    const __m256i eight = _mm256_set1_epi32(8);
+    for (int k = 0; k < count; ++k)
+    {
+        int i = cities[k];
+        const int *row = c.row(i);
+        __m256i self = _mm256_set1_epi32(i);
+        __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256i minimum = _mm256_set1_epi32(INT_MAX);
+        __m256i argmin = _mm256_set1_epi32(-1);
+        int j = 0;
+        for (; j + 8 <= c.n; j += 8)
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(row + j));
+            // strictly smaller and not the diagonal: each lane keeps its first minimum
+            __m256i better = _mm256_andnot_si256(_mm256_cmpeq_epi32(index, self), _mm256_cmpgt_epi32(minimum, v));
+            minimum = _mm256_blendv_epi8(minimum, v, better);
+            argmin = _mm256_blendv_epi8(argmin, index, better);
+            index = _mm256_add_epi32(index, eight);
+        }
+        int values[8], indices[8];
+        _mm256_storeu_si256((__m256i *)values, minimum);
+        _mm256_storeu_si256((__m256i *)indices, argmin);
+        int value = INT_MAX;
+        best[k] = -1;
+        reduceMinimum(values, indices, 8, value, best[k]);
+        rowMinimumFrom(row, c.n, i, j, value, best[k]);
+    }
+}
+
+__attribute__((target("avx2"))) static void bestPredecessorsAvx2(const CostMatrix &c, const int *cities, int count, int *best, int *value)
+{
+    int vectorised = count / 8 * 8;
+    for (int j = 0; j < c.n; ++j)
+    {
+        const int *row = c.row(j);
+        __m256i self = _mm256_set1_epi32(j);
+        for (int k = 0; k < vectorised; k += 8)
+        {
+            __m256i city = _mm256_loadu_si256((const __m256i *)(cities + k));
+            __m256i v = _mm256_i32gather_epi32(row, city, 4);
+            __m256i minimum = _mm256_loadu_si256((const __m256i *)(value + k));
+            __m256i better = _mm256_andnot_si256(_mm256_cmpeq_epi32(city, self), _mm256_cmpgt_epi32(minimum, v));
+            _mm256_storeu_si256((__m256i *)(value + k), _mm256_blendv_epi8(minimum, v, better));
+            __m256i argmin = _mm256_loadu_si256((const __m256i *)(best + k));
+            _mm256_storeu_si256((__m256i *)(best + k), _mm256_blendv_epi8(argmin, self, better));
+        }
+        columnMinimumFrom(row, j, cities, count, best, value, vectorised);
+    }
+}
+
+static const KernelTable avx2Table = {tourCostAvx2, insertionDeltasAvx2, bestSuccessorsAvx2, bestPredecessorsAvx2};
+
+// --- AVX-512: 16 lanes, with mask registers ---
+
+__attribute__((target("avx512f"))) static long long tourCostAvx512(const CostMatrix &c, const int *tour, int n)
+{
+    const __m512i stride = _mm512_set1_epi32(c.stride);
+    __m512i sum = _mm512_setzero_si512();
+    int k = 0;
+    for (; k + 16 < n; k += 16)
+    {
+        __m512i a = _mm512_loadu_si512((const void *)(tour + k));
+        __m512i b = _mm512_loadu_si512((const void *)(tour + k + 1));
+        __m512i cost = _mm512_i32gather_epi32(_mm512_add_epi32(_mm512_mullo_epi32(a, stride), b), c.data.data(), 4);
+        sum = _mm512_add_epi64(sum, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(cost)));
+        sum = _mm512_add_epi64(sum, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(cost, 1)));
+    }
+    long long cost = _mm512_reduce_add_epi64(sum);
+    for (; k + 1 < n; ++k)
+        cost += c.row(tour[k])[tour[k + 1]];
+    return cost + c.row(tour[n - 1])[tour[0]];
+}
+
+__attribute__((target("avx512f"))) static void insertionDeltasAvx512(const CostMatrix &c, const int *tour, int n, int first, int last, int *delta)
+{
+    const __m512i stride = _mm512_set1_epi32(c.stride);
+    const __m512i toFirst = _mm512_set1_epi32(first);
+    const __m512i fromLast = _mm512_set1_epi32(last * c.stride);
+    int k = 0;
+    for (; k + 16 < n; k += 16)
+    {
+        __m512i a = _mm512_mullo_epi32(_mm512_loadu_si512((const void *)(tour + k)), stride);
+        __m512i b = _mm512_loadu_si512((const void *)(tour + k + 1));
+        __m512i in = _mm512_i32gather_epi32(_mm512_add_epi32(a, toFirst), c.data.data(), 4);
+        __m512i out = _mm512_i32gather_epi32(_mm512_add_epi32(fromLast, b), c.data.data(), 4);
+        __m512i removed = _mm512_i32gather_epi32(_mm512_add_epi32(a, b), c.data.data(), 4);
+        _mm512_storeu_si512((void *)(delta + k), _mm512_sub_epi32(_mm512_add_epi32(in, out), removed));
+    }
+    insertionDeltasFrom(c, tour, n, first, last, delta, k);
+}
+
+__attribute__((target("avx512f"))) static void bestSuccessorsAvx512(const CostMatrix &c, const int *cities, int count, int *best)
+{
+    const __m512i sixteen = _mm512_set1_epi32(16);
+    for (int k = 0; k < count; ++k)
+    {
+        int i = cities[k];
+        const int *row = c.row(i);
+        __m512i self = _mm512_set1_epi32(i);
+        __m512i index = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        __m512i minimum = _mm512_set1_epi32(INT_MAX);
+        __m512i argmin = _mm512_set1_epi32(-1);
+        int j = 0;
+        for (; j + 16 <= c.n; j += 16)
+        {
+            __m512i v = _mm512_loadu_si512((const void *)(row + j));
+            __mmask16 better = _mm512_mask_cmplt_epi32_mask(_mm512_cmpneq_epi32_mask(index, self), v, minimum);
+            minimum = _mm512_mask_mov_epi32(minimum, better, v);
+            argmin = _mm512_mask_mov_epi32(argmin, better, index);
+            index = _mm512_add_epi32(index, sixteen);
+        }
+        int values[16], indices[16];
+        _mm512_storeu_si512((void *)values, minimum);
+        _mm512_storeu_si512((void *)indices, argmin);
+        int value = INT_MAX;
+        best[k] = -1;
+        reduceMinimum(values, indices, 16, value, best[k]);
+        rowMinimumFrom(row, c.n, i, j, value, best[k]);
+    }
+}
+
+__attribute__((target("avx512f"))) static void bestPredecessorsAvx512(const CostMatrix &c, const int *cities, int count, int *best, int *value)
+{
+    int vectorised = count / 16 * 16;
+    for (int j = 0; j < c.n; ++j)
+    {
+        const int *row = c.row(j);
+        __m512i self = _mm512_set1_epi32(j);
+        for (int k = 0; k < vectorised; k += 16)
+        {
+            __m512i city = _mm512_loadu_si512((const void *)(cities + k));
+            __m512i v = _mm512_i32gather_epi32(city, row, 4);
+            __m512i minimum = _mm512_loadu_si512((const void *)(value + k));
+            __mmask16 better = _mm512_mask_cmplt_epi32_mask(_mm512_cmpneq_epi32_mask(city, self), v, minimum);
+            _mm512_mask_storeu_epi32(value + k, better, v);
+            _mm512_mask_storeu_epi32(best + k, better, self);
+        }
+        columnMinimumFrom(row, j, cities, count, best, value, vectorised);
+    }
+}
+
+static const KernelTable avx512Table = {tourCostAvx512, insertionDeltasAvx512, bestSuccessorsAvx512, bestPredecessorsAvx512};
+
+#endif
+
+// --- dispatch ---
+
+KernelLevel supportedKernels()
+{
+#ifdef KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return Avx512Kernels;
+    if (__builtin_cpu_supports("avx2"))
+        return Avx2Kernels;
+#endif
+    return ScalarKernels;
+}
+
+static KernelLevel level = supportedKernels();
+
+static const KernelTable &table()
+{
+#ifdef KERNELS_X86
+    if (level == Avx512Kernels)
+        return avx512Table;
+    if (level == Avx2Kernels)
+        return avx2Table;
+#endif
+    return scalarTable;
+}
+
+KernelLevel setKernels(KernelLevel _level)
+{
+    level = _level < supportedKernels() ? _level : supportedKernels();
+    return level;
+}
+
+KernelLevel currentKernels()
+{
+    return level;
+}
+
+std::string kernelName(KernelLevel kernels)
+{
+    const char *names[] = {"scalar", "avx2", "avx512"};
+    return names[kernels];
+}
+
+long long tourCostBatch(const CostMatrix &c, const std::vector<int> &tour)
+{
+    if (tour.empty())
+        return 0;
+    return table().tourCost(c, tour.data(), tour.size());
+}
+
+void insertionDeltas(const CostMatrix &c, const std::vector<int> &tour, int first, int last, std::vector<int> &delta)
+{
+    delta.resize(tour.size());
+    if (!tour.empty())
+        table().insertionDeltas(c, tour.data(), tour.size(), first, last, delta.data());
+}
+
+void bestSuccessors(const CostMatrix &c, const std::vector<int> &cities, std::vector<int> &best)
+{
+    best.resize(cities.size());
+    table().bestSuccessors(c, cities.data(), cities.size(), best.data());
+}
+
+void bestPredecessors(const CostMatrix &c, const std::vector<int> &cities, std::vector<int> &best)
+{
+    best.assign(cities.size(), -1);
+    std::vector<int> value(cities.size(), INT_MAX);
+    table().bestPredecessors(c, cities.data(), cities.size(), best.data(), value.data());
+}
@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include "lns.hpp"
+#include "assignment.hpp"
+#include "balas.hpp"
+#include "heuristic.hpp"
+#include "parser.hpp"
+#include "subtour.hpp"
+#include "tour.hpp"
+
+static std::vector<int> predecessors(const std::vector<int> &succ)
+{
+    std::vector<int> pred(succ.size());
+    for (size_t i = 0; i < succ.size(); ++i)
+        pred[succ[i]] = i;
+    return pred;
+}
+
+// fills the windows one after the other with the candidates, in their order,
+// skipping the cities next (in the tour) to a city of another window
+static std::vector<std::vector<int>> fillWindows(const std::vector<int> &order, const std::vector<int> &succ, int count, int size)
+{
+    std::vector<int> pred = predecessors(succ);
+    std::vector<int> owner(succ.size(), -1);
+    std::vector<std::vector<int>> windows(1);
+    for (int v : order)
+    {
+        int w = windows.size() - 1;
+        if ((int)windows[w].size() == size)
+        {
+            if (w + 1 == count)
+                break;
+            windows.push_back(std::vector<int>());
+            w++;
+        }
+        if (owner[v] >= 0 || (owner[pred[v]] >= 0 && owner[pred[v]] != w) || (owner[succ[v]] >= 0 && owner[succ[v]] != w))
+            continue;
+        owner[v] = w;
+        windows[w].push_back(v);
+    }
+    return windows;
+}
+
+std::vector<std::vector<int>> destroyWindows(const std::vector<std::vector<int>> &c, const std::vector<int> &succ, WindowKind kind, int count, int size, std::mt19937 &rng)
+{
+    int n = succ.size();
+    // each window needs at least one city between it and the next one
+    count = std::max(1, std::min(count, n / 3));
+    size = std::max(2, std::min(size, n / count - 1));
+
+    std::vector<int> order;
+    if (kind == SEGMENT_WINDOW)
+    {
+        std::vector<int> tour = successorsToTour(succ, rng() % n);
+        std::vector<std::vector<int>> windows(count);
+        for (int w = 0; w < count; ++w)
+        {
+            int start = w * (n / count);
+            windows[w].assign(tour.begin() + start, tour.begin() + start + size);
+        }
+        return windows;
+    }
+    else if (kind == RANDOM_WINDOW)
+    {
+        order.resize(n);
+        for (int i = 0; i < n; ++i)
+            order[i] = i;
+        std::shuffle(order.begin(), order.end(), rng);
+    }
+    else
+    {
+        // regret of each city, perturbed so that the same cities are not always chosen
+        std::uniform_real_distribution<double> noise(0.5, 1.5);
+        std::vector<std::pair<double, int>> regrets;
+        for (int i = 0; i < n; ++i)
+        {
+            int cheapest = forbiddenCost;
+            for (int j = 0; j < n; ++j)
+            {
+                if (j != i)
+                    cheapest = std::min(cheapest, c[i][j]);
+            }
+            regrets.push_back(std::make_pair(-(c[i][succ[i]] - cheapest + 1.0) * noise(rng), i));
+        }
+        std::sort(regrets.begin(), regrets.end());
+        for (const std::pair<double, int> &regret : regrets)
+            order.push_back(regret.second);
+    }
+    return fillWindows(order, succ, count, size);
+}
+
+Contraction contract(const std::vector<std::vector<int>> &c, const std::vector<int> &succ, const std::vector<int> &window)
+{
+    int n = succ.size();
+    std::vector<char> inWindow(n, 0);
+    for (int v : window)
+        inWindow[v] = 1;
+    std::vector<int> pred = predecessors(succ);
+
+    Contraction k;
+    std::vector<int> node(n, -1); ///< node of the smaller instance entered at each city
+    for (int v : window)
+    {
+        node[v] = k.first.size();
+        k.first.push_back(v);
+        k.last.push_back(v);
+    }
+    // the fixed paths start right after a city of the window
+    for (int u = 0; u < n; ++u)
+    {
+        if (inWindow[u] || !inWindow[pred[u]])
+            continue;
+        int b = u;
+        while (!inWindow[succ[b]])
+            b = succ[b];
+        node[u] = k.first.size();
+        k.first.push_back(u);
+        k.last.push_back(b);
+    }
+
+    int s = k.first.size();
+    k.c.assign(s, std::vector<int>(s, forbiddenCost));
+    k.succ.resize(s);
+    for (int p = 0; p < s; ++p)
+    {
+        for (int q = 0; q < s; ++q)
+        {
+            if (p != q)
+                k.c[p][q] = c[k.last[p]][k.first[q]];
+        }
+        k.succ[p] = node[succ[k.last[p]]];
+    }
+    return k;
+}
+
+std::vector<int> expand(const Contraction &contraction, const std::vector<int> &succ, const std::vector<int> &contractedSucc)
+{
+    std::vector<int> expanded = succ;
+    for (size_t p = 0; p < contractedSucc.size(); ++p)
+        expanded[contraction.last[p]] = contraction.first[contractedSucc[p]];
+    return expanded;
+}
+
+std::vector<int> startingTour(const std::vector<std::vector<int>> &c, long long &lowerBound, int polish)
+{
+    std::vector<int> succ;
+    lowerBound = -1;
+    if (c.size() <= 1000)
+    {
+        Assignment ap = solveAssignment(c);
+        lowerBound = ap.cost;
+        succ = ap.succ;
+        patchCycles(c, succ);
+    }
+    else
+        succ = nearestNeighbour(c);
+    orOpt(c, succ);
+    if (polish > 0)
+    {
+        std::mt19937 rng(1);
+        balasSimonettiSearch(c, succ, BalasSimonettiTable(polish), rng);
+    }
+    return succ;
+}
+
+std::vector<int> lns(const std::vector<std::vector<int>> &c, std::vector<int> succ, long long lowerBound, const LnsOptions &options, Trace &trace, LnsStats &stats)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int n = succ.size();
+    long long cost = successorCost(c, succ);
+    double bound = lowerBound >= 0 ? (double)lowerBound : -GRB_INFINITY;
+    stats.rounds = stats.repairs = stats.improvements = stats.timeouts = 0;
+    stats.window = options.window;
+    trace.record(0.0, cost, bound, 0);
+    if (n < 8)
+        return succ;
+
+    int threads = std::max(1, options.threads);
+    int minWindow = 4;
+    int maxWindow = std::max(minWindow, std::min(400, n / threads - 1));
+    int size = std::max(minWindow, std::min(maxWindow, options.window));
+    std::mt19937 rng(options.seed);
+    BalasSimonettiTable table(options.polish);
+
+    // one environment per thread: a Gurobi environment is not shared between threads
+    std::vector<GRBEnv *> envs;
+    for (int t = 0; t < threads; ++t)
+    {
+        envs.push_back(new GRBEnv(true));
+        envs.back()->set(GRB_IntParam_OutputFlag, 0);
+        envs.back()->start();
+    }
+
+    double elapsed = 0;
+    while ((elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()) < options.timeLimit)
+    {
+        WindowKind kind = (WindowKind)(stats.rounds % 3);
+        std::vector<std::vector<int>> windows = destroyWindows(c, succ, kind, threads, size, rng);
+        int count = windows.size();
+        double repairLimit = std::min(options.repairLimit, options.timeLimit - elapsed);
+
+        std::vector<std::vector<int>> repaired(count);
+        std::vector<char> optimal(count, 1);
+        std::vector<std::thread> workers;
+        for (int w = 0; w < count; ++w)
+        {
+            workers.push_back(std::thread([&, w]() {
+                Contraction k = contract(c, succ, windows[w]);
+                if (k.first.size() < 3)
+                    return;
+                std::vector<int> tour = k.succ;
+                bool proven = false;
+                try
+                {
+                    if (solveSubtour(*envs[w], k.c, repairLimit, tour, proven))
+                        repaired[w] = expand(k, succ, tour);
+                }
+                catch (GRBException e)
+                {
+                    // the window keeps its tour
+                    std::cerr << "Repair failed: " << e.getMessage() << std::endl;
+                }
+                optimal[w] = proven;
+            }));
+        }
+        for (std::thread &worker : workers)
+            worker.join();
+        stats.rounds++;
+        stats.repairs += count;
+
+        // the windows share no arc of the tour: the repairs change the
+        // successors of disjoint sets of cities and are applied together,
+        // best first, as long as the result stays a single tour
+        std::vector<std::pair<long long, int>> better;
+        for (int w = 0; w < count; ++w)
+        {
+            stats.timeouts += !optimal[w];
+            if (!repaired[w].empty())
+                better.push_back(std::make_pair(successorCost(c, repaired[w]), w));
+        }
+        std::sort(better.begin(), better.end());
+        std::vector<int> pred = predecessors(succ);
+        std::vector<int> current = succ;
+        for (const std::pair<long long, int> &b : better)
+        {
+            std::vector<int> candidate = current;
+            for (int v : windows[b.second])
+            {
+                candidate[v] = repaired[b.second][v];
+                candidate[pred[v]] = repaired[b.second][pred[v]];
+            }
+            if ((int)cycleFrom(candidate, 0).size() == n)
+            {
+                current = candidate;
+                stats.improvements++;
+            }
+        }
+        long long currentCost = successorCost(c, current);
+        bool improved = currentCost < cost;
+        if (improved)
+        {
+            if (options.polish > 0)
+            {
+                balasSimonettiSearch(c, current, table, rng);
+                currentCost = successorCost(c, current);
+            }
+            succ = current;
+            cost = currentCost;
+        }
+
+        // smaller windows when the repairs are too hard, larger ones when they
+        // no longer find anything
+        if (std::find(optimal.begin(), optimal.end(), 0) != optimal.end())
+            size = std::max(minWindow, size * 4 / 5);
+        else if (!improved)
+            size = std::min(maxWindow, size * 5 / 4 + 1);
+
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        trace.record(elapsed, cost, bound, stats.rounds);
+        if (options.verbose && improved)
+            std::cout << "--> LNS round " << stats.rounds << ": " << cost << " at " << elapsed << " sec (window " << size << ")" << std::endl;
+    }
+    stats.window = size;
+    trace.finish(elapsed, cost, bound, stats.rounds);
+
+    for (GRBEnv *env : envs)
+        delete env;
+    return succ;
+}
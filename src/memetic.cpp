@@ -0,0 +1,405 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include "memetic.hpp"
+#include "heuristic.hpp"
+#include "pool.hpp"
+#include "tour.hpp"
+
+std::vector<std::vector<int>> nearLists(const std::vector<std::vector<int>> &c, int k)
+{
+    int n = c.size();
+    k = std::min(k, n - 1);
+    std::vector<std::vector<int>> near(n);
+    std::vector<int> heads;
+    for (int i = 0; i < n; ++i)
+    {
+        heads.clear();
+        for (int j = 0; j < n; ++j)
+        {
+            if (j != i)
+                heads.push_back(j);
+        }
+        const std::vector<int> &row = c[i];
+        std::partial_sort(heads.begin(), heads.begin() + k, heads.end(), [&row](int a, int b) { return row[a] < row[b]; });
+        near[i].assign(heads.begin(), heads.begin() + k);
+    }
+    return near;
+}
+
+std::vector<std::vector<int>> abCycles(const std::vector<int> &succA, const std::vector<int> &predB)
+{
+    int n = succA.size();
+    std::vector<char> seen(n, 0);
+    std::vector<std::vector<int>> all;
+    for (int v = 0; v < n; ++v)
+    {
+        if (seen[v] || predB[succA[v]] == v)
+            continue;
+        std::vector<int> cycle;
+        for (int w = v; !seen[w]; w = predB[succA[w]])
+        {
+            seen[w] = 1;
+            cycle.push_back(w);
+        }
+        all.push_back(cycle);
+    }
+    return all;
+}
+
+long long eaxChild(const std::vector<std::vector<int>> &c, const std::vector<std::vector<int>> &near, const std::vector<int> &succA, const std::vector<int> &predB,
+                   const std::vector<int> &abCycle, std::vector<int> &child, std::vector<int> &changed, EaxScratch &scratch)
+{
+    int n = succA.size();
+    child = succA;
+    changed.clear();
+    long long delta = 0;
+    // the arc (v, succA[v]) of A becomes the arc (predB[succA[v]], succA[v]) of B
+    for (int v : abCycle)
+    {
+        int w = succA[v];
+        int t = predB[w];
+        delta += (long long)c[t][w] - c[t][succA[t]];
+        child[t] = w;
+        changed.push_back(t);
+    }
+
+    // subtours of the intermediate solution
+    std::vector<int> &pred = scratch.pred;
+    std::vector<int> &cycle = scratch.cycle; ///< subtour of each city
+    std::vector<int> &sizes = scratch.sizes;
+    pred.resize(n);
+    cycle.assign(n, -1);
+    sizes.clear();
+    for (int v = 0; v < n; ++v)
+    {
+        pred[child[v]] = v;
+        if (cycle[v] >= 0)
+            continue;
+        int size = 0;
+        for (int w = v; cycle[w] < 0; w = child[w], ++size)
+            cycle[w] = sizes.size();
+        sizes.push_back(size);
+    }
+
+    // merges the smallest subtour U with another one: u -> x and v -> child[u]
+    // replace u -> child[u] and v = pred[x] -> x
+    int remaining = sizes.size();
+    std::vector<int> &members = scratch.members;
+    while (remaining > 1)
+    {
+        int smallest = -1;
+        for (size_t k = 0; k < sizes.size(); ++k)
+        {
+            if (sizes[k] > 0 && (smallest < 0 || sizes[k] < sizes[smallest]))
+                smallest = k;
+        }
+        members.clear();
+        for (int v = 0; v < n && members.empty(); ++v)
+        {
+            if (cycle[v] == smallest)
+            {
+                members.push_back(v);
+                for (int w = child[v]; w != v; w = child[w])
+                    members.push_back(w);
+            }
+        }
+
+        long long best = 0;
+        int bestU = -1, bestX = -1;
+        for (int pass = 0; pass < 2 && bestU < 0; ++pass)
+        {
+            // the near lists first, every city if none of them leaves U
+            for (int u : members)
+            {
+                const std::vector<int> &row = c[u];
+                int su = child[u];
+                int candidates = pass == 0 ? near[u].size() : n;
+                for (int k = 0; k < candidates; ++k)
+                {
+                    int x = pass == 0 ? near[u][k] : k;
+                    if (cycle[x] == smallest)
+                        continue;
+                    int v = pred[x];
+                    long long gain = (long long)row[x] + c[v][su] - row[su] - c[v][x];
+                    if (bestU < 0 || gain < best)
+                    {
+                        best = gain;
+                        bestU = u;
+                        bestX = x;
+                    }
+                }
+            }
+        }
+        int u = bestU, x = bestX, v = pred[x], su = child[u];
+        child[u] = x;
+        pred[x] = u;
+        child[v] = su;
+        pred[su] = v;
+        delta += best;
+        changed.push_back(u);
+        changed.push_back(v);
+        int into = cycle[x];
+        for (int w : members)
+            cycle[w] = into;
+        sizes[into] += sizes[smallest];
+        sizes[smallest] = 0;
+        remaining--;
+    }
+    return delta;
+}
+
+namespace
+{
+    // number of individuals of the population using each arc, for the entropy
+    // H = - sum over the arcs of F(e)/N log(F(e)/N)
+    class ArcFrequency
+    {
+    public:
+        ArcFrequency(int n, int population) : heads(n), size(population) {}
+
+        int count(int i, int j) const
+        {
+            for (const std::pair<int, int> &head : heads[i])
+            {
+                if (head.first == j)
+                    return head.second;
+            }
+            return 0;
+        }
+
+        void add(int i, int j, int delta)
+        {
+            std::vector<std::pair<int, int>> &row = heads[i];
+            for (size_t k = 0; k < row.size(); ++k)
+            {
+                if (row[k].first == j)
+                {
+                    row[k].second += delta;
+                    if (row[k].second == 0)
+                    {
+                        row[k] = row.back();
+                        row.pop_back();
+                    }
+                    return;
+                }
+            }
+            row.push_back(std::make_pair(j, delta));
+        }
+
+        void add(const std::vector<int> &succ, int delta)
+        {
+            for (size_t i = 0; i < succ.size(); ++i)
+                add(i, succ[i], delta);
+        }
+
+        double term(int f) const
+        {
+            return f <= 0 ? 0.0 : -(double)f / size * log((double)f / size);
+        }
+
+        double entropy() const
+        {
+            double h = 0;
+            for (const std::vector<std::pair<int, int>> &row : heads)
+                for (const std::pair<int, int> &head : row)
+                    h += term(head.second);
+            return h;
+        }
+
+        // change of the entropy when the individual A is replaced by the child
+        // (the cities of changed are the only ones whose successor may differ)
+        double change(const std::vector<int> &succA, const std::vector<int> &child, const std::vector<int> &changed) const
+        {
+            double dh = 0;
+            for (int v : changed)
+            {
+                if (child[v] == succA[v])
+                    continue;
+                int removed = count(v, succA[v]);
+                int added = count(v, child[v]);
+                dh += term(removed - 1) - term(removed) + term(added + 1) - term(added);
+            }
+            return dh;
+        }
+
+    private:
+        std::vector<std::vector<std::pair<int, int>>> heads;
+        int size;
+    };
+
+    // score of a child replacing its parent: the gain in length per unit of
+    // entropy lost, and the gain alone (scaled up) if the entropy does not decrease
+    double score(long long gain, double entropyChange)
+    {
+        if (entropyChange >= 0)
+            return gain * 1e9;
+        return gain / -entropyChange;
+    }
+
+    // changed cities counted once, for the evaluation of a child
+    void unique(std::vector<int> &changed, std::vector<char> &mark)
+    {
+        size_t kept = 0;
+        for (int v : changed)
+        {
+            if (!mark[v])
+            {
+                mark[v] = 1;
+                changed[kept++] = v;
+            }
+        }
+        changed.resize(kept);
+        for (int v : changed)
+            mark[v] = 0;
+    }
+
+    struct Worker
+    {
+        std::mt19937_64 rng;
+        EaxScratch eax;
+        std::vector<int> predB, child, best, changed, bestChanged, orOptPred, tour;
+        std::vector<char> visited, mark;
+    };
+}
+
+MemeticResult memetic(const std::vector<std::vector<int>> &c, const MemeticOptions &options)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int n = c.size();
+    int size = std::max(2, options.population);
+    std::vector<std::vector<int>> near = nearLists(c, 10);
+
+    TaskPool pool(options.threads);
+    std::vector<Worker> workers(pool.size());
+    for (int w = 0; w < pool.size(); ++w)
+    {
+        std::seed_seq sequence = {options.seed, (unsigned)w, 0xea8u};
+        workers[w].rng.seed(sequence);
+        workers[w].mark.assign(n, 0);
+    }
+
+    // initial population: randomised nearest neighbour tours improved by Or-opt
+    std::vector<std::vector<int>> population(size);
+    std::vector<long long> cost(size);
+    for (int p = 0; p < size; ++p)
+    {
+        pool.submit([&, p](int w) {
+            Worker &s = workers[w];
+            randomNearestNeighbour(c, s.rng, 3, population[p], s.visited);
+            orOpt(c, population[p], 3, s.orOptPred);
+            cost[p] = successorCost(c, population[p]);
+        });
+    }
+    pool.wait();
+
+    ArcFrequency frequency(n, size);
+    for (const std::vector<int> &individual : population)
+        frequency.add(individual, 1);
+
+    MemeticResult result;
+    int bestIndex = std::min_element(cost.begin(), cost.end()) - cost.begin();
+    result.succ = population[bestIndex];
+    result.cost = cost[bestIndex];
+    result.generations = 0;
+    result.offspring = 0;
+
+    std::mt19937_64 rng(options.seed);
+    int stalled = 0;
+    std::vector<std::vector<int>> next(size);
+    std::vector<long long> nextCost(size);
+    std::vector<char> replaced(size);
+    auto elapsed = [&start]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+    while (elapsed() < options.timeLimit && stalled < options.stall && (options.target < 0 || result.cost > options.target))
+    {
+        std::vector<int> order(size);
+        for (int p = 0; p < size; ++p)
+            order[p] = p;
+        std::shuffle(order.begin(), order.end(), rng);
+        std::fill(replaced.begin(), replaced.end(), 0);
+
+        // the children are built from the population of the start of the
+        // generation, and evaluated with its arc frequencies
+        for (int k = 0; k < size; ++k)
+        {
+            pool.submit([&, k](int w) {
+                Worker &s = workers[w];
+                int a = order[k], b = order[(k + 1) % size];
+                const std::vector<int> &A = population[a], &B = population[b];
+                s.predB.resize(n);
+                for (int v = 0; v < n; ++v)
+                    s.predB[B[v]] = v;
+                std::vector<std::vector<int>> cycles = abCycles(A, s.predB);
+                if (cycles.empty())
+                    return;
+                std::shuffle(cycles.begin(), cycles.end(), s.rng);
+                if ((int)cycles.size() > options.children)
+                    cycles.resize(options.children);
+
+                double bestScore = 0;
+                bool found = false;
+                for (const std::vector<int> &abCycle : cycles)
+                {
+                    long long delta = eaxChild(c, near, A, s.predB, abCycle, s.child, s.changed, s.eax);
+                    unique(s.changed, s.mark);
+                    double childScore = score(-delta, frequency.change(A, s.child, s.changed));
+                    if (!found || childScore > bestScore)
+                    {
+                        found = true;
+                        bestScore = childScore;
+                        s.best.swap(s.child);
+                        s.bestChanged.swap(s.changed);
+                    }
+                }
+
+                // mutation, then the child replaces A if it is shorter, or as
+                // short and more diverse
+                orOpt(c, s.best, 3, s.orOptPred);
+                s.bestChanged.clear();
+                for (int v = 0; v < n; ++v)
+                {
+                    if (s.best[v] != A[v])
+                        s.bestChanged.push_back(v);
+                }
+                long long childCost = successorCost(c, s.best);
+                long long gain = cost[a] - childCost;
+                double dh = frequency.change(A, s.best, s.bestChanged);
+                if (gain > 0 || (gain == 0 && dh > 0))
+                {
+                    next[a] = s.best;
+                    nextCost[a] = childCost;
+                    replaced[a] = 1;
+                }
+            });
+        }
+        pool.wait();
+
+        for (int p = 0; p < size; ++p)
+        {
+            if (!replaced[p])
+                continue;
+            frequency.add(population[p], -1);
+            population[p].swap(next[p]);
+            cost[p] = nextCost[p];
+            frequency.add(population[p], 1);
+            result.offspring++;
+        }
+        result.generations++;
+
+        bestIndex = std::min_element(cost.begin(), cost.end()) - cost.begin();
+        if (cost[bestIndex] < result.cost)
+        {
+            result.cost = cost[bestIndex];
+            result.succ = population[bestIndex];
+            stalled = 0;
+            if (options.verbose)
+                std::cout << "--> Generation " << result.generations << ": " << result.cost << " at " << elapsed() << " sec (entropy " << frequency.entropy() << ")" << std::endl;
+        }
+        else
+            stalled++;
+    }
+    result.entropy = frequency.entropy();
+    result.seconds = elapsed();
+    return result;
+}
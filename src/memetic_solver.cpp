@@ -0,0 +1,76 @@
+#include "config.hpp"
+#include "memetic.hpp"
+#include "parser.hpp"
+#include "relabel.hpp"
+#include "tour.hpp"
+#include <chrono>
+#include <iostream>
+using namespace std;
+
+// Memetic solver: edge assembly crossover on a population of tours, children
+// built in parallel (see memetic.hpp). Like heuristic.out it gives no proof of
+// optimality, and prints a Result line in the format of the models.
+//
+// usage : ./memetic.out <PATH_TO_DAT_FILE> [-nv] [--time-limit=10] [--threads=N] [--population=100] [--children=30] [--stall=50] [--seed=1] [--relabel] [--target=cost]
+
+int main(int argc,
+         char *argv[])
+{
+    Config config = parseArgs(argc, argv, 10.0);
+    bool verbose = config.verbose;
+
+    // parse and save the data
+    vector<vector<int>> c = parse(argv[1]);
+    int n = c.size();
+
+    // --relabel: the search runs on the cities numbered along a heuristic tour (see relabel.hpp)
+    Relabelling relabelling;
+    double relabelSeconds = 0;
+    if (config.has("relabel"))
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        relabelling = localityRelabelling(c);
+        c = relabelMatrix(c, relabelling);
+        relabelSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+
+    MemeticOptions options;
+    options.threads = config.threads;
+    options.population = (int)config.number("population", 100);
+    options.children = (int)config.number("children", 30);
+    options.stall = (int)config.number("stall", 50);
+    options.timeLimit = config.timeLimit;
+    options.seed = (unsigned)config.number("seed", 1);
+    options.target = (long long)config.number("target", -1);
+    options.verbose = verbose;
+    if (verbose)
+        cout << "--> Memetic algorithm, population of " << options.population << " on " << options.threads << " threads" << endl;
+
+    MemeticResult result = memetic(c, options);
+
+    if (config.has("relabel"))
+        result.succ = originalSuccessors(result.succ, relabelling);
+
+    cout << "Result: ";
+    cout << argv[1] << "; ";
+    cout << "runtime = " << result.seconds << " sec; ";
+    cout << "objective value = " << result.cost << "; ";
+    cout << "generations = " << result.generations << "; ";
+    cout << "offspring = " << result.offspring << "; ";
+    cout << "entropy = " << result.entropy << "; ";
+    cout << "threads = " << options.threads;
+    if (config.has("relabel"))
+        cout << "; relabelling = " << relabelSeconds << " sec";
+    cout << endl;
+
+    if (verbose)
+    {
+        for (int i = 0, step = 0; step < n; ++step)
+        {
+            cout << "ville " << i << " --> "
+                 << "ville " << result.succ[i] << endl;
+            i = result.succ[i];
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include "memory.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+static std::mutex allocationMutex;
+static long long allocatedBytes = 0;
+static double allocationSeconds = 0;
+
+void recordAllocation(size_t bytes, double seconds)
+{
+    std::lock_guard<std::mutex> lock(allocationMutex);
+    allocatedBytes += bytes;
+    allocationSeconds += seconds;
+}
+
+double peakRss()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1e6; //< bytes
+#else
+    return usage.ru_maxrss / 1e3; //< kilobytes
+#endif
+#else
+    return 0;
+#endif
+}
+
+std::string memoryFields()
+{
+    std::lock_guard<std::mutex> lock(allocationMutex);
+    std::stringstream ss;
+    ss << "peak rss = " << peakRss() << " MB; ";
+    ss << "variable arrays = " << allocatedBytes / 1e6 << " MB; ";
+    ss << "allocation time = " << allocationSeconds << " sec";
+    return ss.str();
+}
+
+// bytes per variable (our handle, the name and the column of Gurobi) and per
+// nonzero (row and column copies of the matrix, then one more per thread);
+// rough figures, to be checked against the peak rss of actual runs
+const double bytesPerVar = 200;
+const double bytesPerNonzero = 32;
+const double bytesPerNonzeroAndThread = 16;
+
+double predictedMemory(long long vars, long long nonzeros, int threads)
+{
+    return (vars * bytesPerVar + nonzeros * (bytesPerNonzero + threads * bytesPerNonzeroAndThread)) / 1e6;
+}
+
+void fitMemoryBudget(Config &config, long long vars, long long nonzeros)
+{
+    if (!config.has("memory-budget"))
+        return;
+    double budget = config.number("memory-budget", 0);
+    int threads = config.threads;
+    while (threads > 1 && predictedMemory(vars, nonzeros, threads) > budget)
+        threads--;
+    double predicted = predictedMemory(vars, nonzeros, threads);
+    if (predicted > budget)
+    {
+        std::cout << "Refused: " << config.instance << "; predicted memory = " << predicted << " MB; memory budget = " << budget << " MB; "
+                  << "vars = " << vars << "; nonzeros = " << nonzeros << std::endl;
+        exit(-1);
+    }
+    if (threads < config.threads && config.verbose)
+        std::cout << "--> " << threads << " threads instead of " << config.threads << " to fit the memory budget (" << predicted << " MB predicted)" << std::endl;
+    config.threads = threads;
+}
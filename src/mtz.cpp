@@ -1,21 +1,170 @@
 #include "gurobi_c++.h"
+#include "graph.hpp"
 #include "parser.hpp"
+#include "memory.hpp"
+#include "solver.hpp"
+#include "callback.hpp"
+#include "cutlib.hpp"
+#include "tour.hpp"
+#include <algorithm>
 #include <cstring>
 using namespace std;
 
-int main(int argc,
-         char *argv[])
+// MTZ constraints of the arcs (i,j), i, j != 0: u(i) - u(j) + (n-1) x(i,j) <= n-2,
+// lifted with (n-3) x(j,i) on the left (Desrochers and Laporte) with --lifted
+class MtzConstraints
+{
+public:
+     const Graph *g;
+     GRBVar *x, *u;
+     int n;
+     bool lifted;
+
+     MtzConstraints(const Graph *_g, GRBVar *_x, GRBVar *_u, bool _lifted)
+     {
+          g = _g;
+          x = _x;
+          u = _u;
+          n = _g->n;
+          lifted = _lifted;
+     }
+     // false for the arcs into or out of city 0
+     bool has(int a) const
+     {
+          return g->tail[a] != 0 && g->head[a] != 0;
+     }
+     GRBTempConstr constraint(int a) const
+     {
+          int i = g->tail[a], j = g->head[a];
+          GRBLinExpr lhs = u[i] - u[j] + (n - 1) * x[a];
+          int back = g->arc(j, i);
+          if (lifted && back >= 0)
+               lhs += (n - 3) * x[back];
+          return lhs <= n - 2;
+     }
+     // left-hand side minus right-hand side at a point (xVal per arc, uVal per city)
+     double violation(int a, const double *xVal, const double *uVal) const
+     {
+          int i = g->tail[a], j = g->head[a];
+          double lhs = uVal[i] - uVal[j] + (n - 1) * xVal[a];
+          int back = g->arc(j, i);
+          if (lifted && back >= 0)
+               lhs += (n - 3) * xVal[back];
+          return lhs - (n - 2);
+     }
+};
+
+// lazy MTZ (--lazy): the model starts with the assignment constraints only. At
+// MIPSOL, every subtour of the solution not through city 0 gets the violated
+// MTZ constraints of its arcs, one at least (the u increase along the arcs of
+// a cycle), added before or not. With --lazy-node, the most violated MTZ
+// constraints of the node relaxation not added yet are added as well.
+class LazyMtzCallback : public ModelCallback
 {
-     bool verbose = true;
-     if (argv[2] != NULL && strcmp(argv[2], "-nv") == 0)
+public:
+     const MtzConstraints *mtz;
+     const Graph *g;
+     int n;
+     int nodeCuts;       ///< most violated constraints added at each node, 0 if only at MIPSOL
+     vector<char> added; ///< per arc, its constraint is in the model (filters the node cuts)
+
+     LazyMtzCallback(const MtzConstraints *_mtz, int _nodeCuts)
      {
-          verbose = false;
+          mtz = _mtz;
+          g = _mtz->g;
+          n = g->n;
+          nodeCuts = _nodeCuts;
+          added.assign(g->m, 0);
      }
+
+protected:
+     void separate()
+     {
+          try
+          {
+               if (where == GRB_CB_MIPSOL)
+               {
+                    double *xVal = getSolution(mtz->x, g->m);
+                    double *uVal = getSolution(mtz->u, n);
+                    vector<int> succ(n, -1);
+                    for (int a = 0; a < g->m; ++a)
+                    {
+                         if (xVal[a] >= 0.5)
+                              succ[g->tail[a]] = g->head[a];
+                    }
+                    for (const vector<int> &cycle : cycles(succ))
+                    {
+                         if (find(cycle.begin(), cycle.end(), 0) != cycle.end())
+                              continue;
+                         for (int i : cycle)
+                         {
+                              // a constraint already added may be violated again: Gurobi
+                              // must be told each time
+                              int a = g->arc(i, succ[i]);
+                              if (a >= 0 && mtz->violation(a, xVal, uVal) > 1e-6)
+                                   add(a, xVal, uVal);
+                         }
+                    }
+                    delete[] xVal;
+                    delete[] uVal;
+               }
+               else if (where == GRB_CB_MIPNODE && nodeCuts > 0 && getIntInfo(GRB_CB_MIPNODE_STATUS) == GRB_OPTIMAL)
+               {
+                    double *xVal = getNodeRel(mtz->x, g->m);
+                    double *uVal = getNodeRel(mtz->u, n);
+                    vector<pair<double, int>> violated;
+                    for (int a = 0; a < g->m; ++a)
+                    {
+                         if (!added[a] && mtz->has(a) && xVal[a] > 1e-6)
+                         {
+                              double violation = mtz->violation(a, xVal, uVal);
+                              if (violation > 1e-6)
+                                   violated.push_back(make_pair(-violation, a));
+                         }
+                    }
+                    sort(violated.begin(), violated.end());
+                    for (size_t k = 0; k < violated.size() && (int)k < nodeCuts; ++k)
+                         add(violated[k].second, xVal, uVal);
+                    delete[] xVal;
+                    delete[] uVal;
+               }
+          }
+          catch (GRBException e)
+          {
+               cout << "Error number: " << e.getErrorCode() << endl;
+               cout << e.getMessage() << endl;
+          }
+          catch (...)
+          {
+               cout << "Error during callback" << endl;
+          }
+     }
+
+     void add(int a, const double *xVal, const double *uVal)
+     {
+          addLazy(mtz->constraint(a), mtz->violation(a, xVal, uVal), {g->tail[a], n + g->head[a]});
+          added[a] = 1;
+     }
+};
+
+int main(int argc,
+         char *argv[])
+{
+     Config config = parseArgs(argc, argv, 600.0);
+     bool verbose = config.verbose;
      // parse and save the data
      vector<vector<int>> c = parse(argv[1]);
      int n = c.size();
 
-     GRBVar **x = nullptr;
+     // only the arcs that can be in an optimal tour get a variable
+     Graph g = buildGraph(c);
+     if (verbose)
+          printReport(g);
+     // --lazy: the MTZ constraints are added by the callback when violated
+     bool lazy = config.has("lazy");
+     fitMemoryBudget(config, g.m + n, (lazy ? 2LL : 5LL) * g.m); //< --memory-budget (see memory.hpp)
+
+     GRBVar *x = nullptr;
      GRBVar *u = nullptr;
      try
      {
@@ -40,35 +189,29 @@ int main(int argc,
           if (verbose)
                cout << "--> Creating the variables" << endl;
 
-          x = new GRBVar *[n];
-          u = new GRBVar[n];
+          x = trackedArray<GRBVar>(g.m);
+          u = trackedArray<GRBVar>(n);
 
-          for (size_t j = 0; j < n; ++j)
+          for (int a = 0; a < g.m; ++a)
+          {
+               stringstream ss;
+               ss << "x(" << g.tail[a] << "," << g.head[a] << ")";
+               x[a] = model.addVar(0.0, 1.0, 0.0, GRB_BINARY, ss.str());
+          }
+          for (int j = 0; j < n; ++j)
           {
-               x[j] = new GRBVar[n];
-               for (size_t i = 0; i < n; ++i)
-               {
-                    stringstream ss;
-                    ss << "x(" << j << "," << i << ")";
-                    x[j][i] = model.addVar(0.0, 1.0, 0.0, GRB_BINARY, ss.str());
-               }
-
                stringstream ss;
                ss << "u(" << j << ")";
-               u[j] = model.addVar(0.0, 1000.0, 0.0, GRB_INTEGER, ss.str());
+               u[j] = model.addVar(0.0, n - 1, 0.0, GRB_INTEGER, ss.str());
           }
 
           // --- Creation of the objective function ---
           if (verbose)
                cout << "--> Creating the objective function" << endl;
           GRBLinExpr obj = 0;
-          for (size_t i = 0; i < n; ++i)
+          for (int a = 0; a < g.m; ++a)
           {
-               for (size_t j = 0; j < n; ++j)
-               {
-                    if (i != j)
-                         obj += c[j][i] * x[j][i];
-               }
+               obj += g.cost[a] * x[a];
           }
           model.setObjective(obj, GRB_MINIMIZE);
 
@@ -77,17 +220,17 @@ int main(int argc,
                cout << "--> Creating the constraints" << endl;
 
           // Respect flot
-          for (size_t j = 0; j < n; ++j)
+          for (int j = 0; j < n; ++j)
           {
                GRBLinExpr flot1 = 0;
                GRBLinExpr flot2 = 0;
-               for (size_t i = 0; i < n; ++i)
+               for (int a = g.outStart[j]; a < g.outStart[j + 1]; ++a)
                {
-                    if (i != j)
-                    {
-                         flot1 += x[j][i];
-                         flot2 += x[i][j];
-                    }
+                    flot1 += x[a];
+               }
+               for (int p = g.inStart[j]; p < g.inStart[j + 1]; ++p)
+               {
+                    flot2 += x[g.inArc[p]];
                }
                stringstream ss;
                ss << "Flot1(" << j << ")";
@@ -96,29 +239,34 @@ int main(int argc,
                model.addConstr(flot2 == 1, ss.str());
           }
 
-          // Elim. sous-tours
-          for (size_t i = 1; i < n; ++i)
+          // Elim. sous-tours (in the callback with --lazy)
+          MtzConstraints mtz(&g, x, u, config.has("lifted"));
+          for (int a = 0; a < g.m && !lazy; ++a)
           {
-               for (size_t j = 1; j < n; ++j)
-               {
-                    GRBLinExpr lhs = u[i] - u[j] + (n - 1) * x[j][i];
-                    stringstream ss;
-                    ss << "Sous-tours(" << j << "," << i << ")";
-                    model.addConstr(lhs <= n - 2, ss.str());
-               }
+               if (!mtz.has(a))
+                    continue;
+               stringstream ss;
+               ss << "Sous-tours(" << g.tail[a] << "," << g.head[a] << ")";
+               model.addConstr(mtz.constraint(a), ss.str());
           }
 
           // Optimize model
           // --- Solver configuration ---
           if (verbose)
                cout << "--> Configuring the solver" << endl;
-          model.set(GRB_DoubleParam_TimeLimit, 600.0); //< sets the time limit (in seconds)
-          model.set(GRB_IntParam_Threads, 1);          //< limits the solver to single thread usage
+          configure(model, config, "mtz", n); //< time limit, threads and parameters (see config.hpp)
+
+          if (lazy)
+               model.set(GRB_IntParam_LazyConstraints, 1);
+          LazyMtzCallback cb(&mtz, lazy && config.has("lazy-node") ? (int)config.number("lazy-node-cuts", 50) : 0); //< samples the progress of the solver (see callback.hpp)
+          model.setCallback(&cb);
+          cb.watch(config, ArcVariables(&g, x), instanceHash(c)); //< --incumbents, --stop-file and --checkpoint
 
           // --- Solver launch ---
           if (verbose)
                cout << "--> Running the solver" << endl;
           model.optimize();
+          finishCallback(model, cb, config);
           // model.write("model.lp"); //< Writes the model in a file
 
           // --- Solver results retrieval ---
@@ -126,9 +274,9 @@ int main(int argc,
                cout << "--> Retrieving solver results " << endl;
 
           int status = model.get(GRB_IntAttr_Status);
-          if (status == GRB_OPTIMAL || (status == GRB_TIME_LIMIT && model.get(GRB_IntAttr_SolCount) > 0))
+          if (status == GRB_OPTIMAL || ((status == GRB_TIME_LIMIT || status == GRB_INTERRUPTED) && model.get(GRB_IntAttr_SolCount) > 0))
           {
-               // the solver has computed the optimal solution or a feasible solution (when the time limit is reached before proving optimality)
+               // the solver has computed the optimal solution or a feasible solution (when the time limit is reached or the run is stopped before proving optimality)
                if (verbose)
                {
                     cout << "Success! (Status: " << status << ")" << endl; //< prints the solver status (see the gurobi documentation)
@@ -138,22 +286,24 @@ int main(int argc,
                cout << "Result: ";
                cout << argv[1] << "; ";
                cout << "runtime = " << model.get(GRB_DoubleAttr_Runtime) << " sec; ";
-               cout << "objective value = " << model.get(GRB_DoubleAttr_ObjVal) << endl; //< gets the value of the objective function for the best computed solution (optimal if no time limit)
+               cout << "objective value = " << model.get(GRB_DoubleAttr_ObjVal) << "; "; //< gets the value of the objective function for the best computed solution (optimal if no time limit)
+               cout << "primal-dual integral = " << cb.trace.primalDualIntegral() << "; root bound = " << cb.trace.rootBound() << "; "; //< integral of the primal-dual gap over time (see trace.hpp)
+               cout << "nodes = " << model.get(GRB_DoubleAttr_NodeCount) << "; ";
+               cout << cb.stats.resultFields() << "; " << resourceFields(model) << endl; //< callback counters (see cutstats.hpp), model size and memory (see memory.hpp)
 
                if (verbose)
                {
-                    int i = 0;
-                    for (size_t j = 0; j < n; j++)
+                    vector<int> succ(n, -1);
+                    for (int a = 0; a < g.m; ++a)
                     {
-                         if (x[j][i].get(GRB_DoubleAttr_X) == 1.0)
-                         {
-                              cout << "ville " << i << " --> "
-                                   << "ville " << j << endl;
-                              i = j;
-                              if (i == 0)
-                                   break;
-                              j = -1;
-                         }
+                         if (x[a].get(GRB_DoubleAttr_X) >= 0.5)
+                              succ[g.tail[a]] = g.head[a];
+                    }
+                    vector<int> tour = successorsToTour(succ);
+                    for (size_t k = 0; k < tour.size(); k++)
+                    {
+                         cout << "ville " << cb.city(tour[k]) << " --> "
+                              << "ville " << cb.city(succ[tour[k]]) << endl;
                     }
                }
                // model.write("solution.sol"); //< Writes the solution in a file
@@ -175,12 +325,6 @@ int main(int argc,
      }
 
      delete[] u;
-
-     for (size_t j = 0; j < n; ++j)
-     {
-          delete[] x[j];
-     }
-
      delete[] x;
 
      return 0;
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include "multistart.hpp"
+#include "heuristic.hpp"
+#include "pool.hpp"
+#include "tour.hpp"
+
+namespace
+{
+    struct Candidate
+    {
+        long long cost;
+        std::vector<int> succ;
+    };
+
+    // best tour published by the workers: a tour replaces the published one by
+    // a compare-and-swap of the pointer, only while its cost is lower. Replaced
+    // tours are freed at the end, as another worker may still be reading them.
+    class BestTour
+    {
+    public:
+        BestTour() : slot(nullptr) {}
+
+        const Candidate *load() const
+        {
+            return slot.load(std::memory_order_acquire);
+        }
+
+        // takes the ownership of candidate; returns true if it was published
+        bool offer(Candidate *candidate, std::vector<Candidate *> &retired)
+        {
+            Candidate *current = slot.load(std::memory_order_acquire);
+            while (current == nullptr || candidate->cost < current->cost)
+            {
+                if (slot.compare_exchange_weak(current, candidate, std::memory_order_acq_rel))
+                {
+                    if (current != nullptr)
+                        retired.push_back(current);
+                    return true;
+                }
+            }
+            retired.push_back(candidate);
+            return false;
+        }
+
+    private:
+        std::atomic<Candidate *> slot;
+    };
+
+    // data of one worker, only touched by the thread running it
+    struct Scratch
+    {
+        std::mt19937_64 rng;
+        std::vector<int> succ, pred, tour;
+        std::vector<char> visited;
+        std::vector<Candidate *> retired;
+        std::vector<Candidate> kept; ///< cheapest distinct tours of the worker, with keep
+        long improvements;
+        char padding[64]; ///< keeps the hot data of two workers off the same cache line
+    };
+
+    // inserts the tour into the keep cheapest distinct ones, sorted by cost
+    void keepTour(std::vector<Candidate> &kept, long long cost, const std::vector<int> &succ, int keep)
+    {
+        if ((int)kept.size() >= keep && cost >= kept.back().cost)
+            return;
+        for (const Candidate &other : kept)
+        {
+            if (other.cost == cost && other.succ == succ)
+                return;
+        }
+        Candidate candidate;
+        candidate.cost = cost;
+        candidate.succ = succ;
+        std::vector<Candidate>::iterator it = std::upper_bound(kept.begin(), kept.end(), candidate,
+                                                               [](const Candidate &a, const Candidate &b) { return a.cost < b.cost; });
+        kept.insert(it, candidate);
+        if ((int)kept.size() > keep)
+            kept.pop_back();
+    }
+}
+
+MultiStartResult multiStart(const std::vector<std::vector<int>> &c, const MultiStartOptions &options)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(options.timeLimit));
+
+    TaskPool pool(options.threads);
+    std::vector<Scratch> scratch(pool.size());
+    for (int w = 0; w < pool.size(); ++w)
+    {
+        std::seed_seq sequence = {options.seed, (unsigned)w, 0x5747u};
+        scratch[w].rng.seed(sequence);
+        scratch[w].improvements = 0;
+    }
+    BestTour best;
+    std::atomic<long> started(0), completed(0);
+
+    std::function<void(int)> task = [&](int w) {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return;
+        long index = started++;
+        if (options.starts > 0 && index >= options.starts)
+            return;
+        Scratch &s = scratch[w];
+        const Candidate *published = best.load();
+        if (index % 2 == 1 && published != nullptr)
+        {
+            s.succ = published->succ;
+            doubleBridge(s.succ, s.rng, s.tour);
+        }
+        else
+            randomNearestNeighbour(c, s.rng, options.candidates, s.succ, s.visited);
+        orOpt(c, s.succ, 3, s.pred);
+
+        long long cost = successorCost(c, s.succ);
+        if (options.keep > 0)
+            keepTour(s.kept, cost, s.succ, options.keep);
+        published = best.load();
+        if (published == nullptr || cost < published->cost)
+        {
+            Candidate *candidate = new Candidate();
+            candidate->cost = cost;
+            candidate->succ = s.succ;
+            if (best.offer(candidate, s.retired))
+                s.improvements++;
+        }
+        completed++;
+        // until the time limit, every start queues the next one on its worker
+        if (options.starts <= 0)
+            pool.submit(task);
+    };
+
+    long initial = options.starts > 0 ? options.starts : 2 * pool.size();
+    for (long k = 0; k < initial; ++k)
+        pool.submit(task);
+    pool.wait();
+
+    MultiStartResult result;
+    const Candidate *winner = best.load();
+    result.succ = winner != nullptr ? winner->succ : std::vector<int>();
+    result.cost = winner != nullptr ? winner->cost : -1;
+    result.starts = completed;
+    result.improvements = 0;
+    std::vector<Candidate> kept;
+    for (Scratch &s : scratch)
+    {
+        for (const Candidate &candidate : s.kept)
+            keepTour(kept, candidate.cost, candidate.succ, options.keep);
+        result.improvements += s.improvements;
+        for (Candidate *candidate : s.retired)
+        {
+            if (candidate != winner)
+                delete candidate;
+        }
+    }
+    delete winner;
+    for (const Candidate &candidate : kept)
+        result.tours.push_back(candidate.succ);
+    result.steals = pool.steals();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include "parser.hpp"
 
@@ -61,3 +62,42 @@ std::vector<std::vector<int>> parse(std::string filePath)
     file.close();
     return matrix;
 }
+
+// compares the matrix with its transpose tile by tile: each tile of the lower
+// triangle is first copied transposed into a small buffer, so that the
+// comparison runs on contiguous rows and can be vectorised by the compiler
+bool isSymmetric(const std::vector<std::vector<int>> &matrix)
+{
+    const int B = 32;
+    int n = matrix.size();
+    int tile[B][B];
+    for (int bi = 0; bi < n; bi += B)
+    {
+        int iEnd = std::min(bi + B, n);
+        for (int bj = bi; bj < n; bj += B)
+        {
+            int jEnd = std::min(bj + B, n);
+            for (int j = bj; j < jEnd; ++j)
+            {
+                if ((int)matrix[j].size() != n)
+                    return false;
+                const int *column = matrix[j].data();
+                for (int i = bi; i < iEnd; ++i)
+                    tile[i - bi][j - bj] = column[i];
+            }
+            for (int i = bi; i < iEnd; ++i)
+            {
+                if ((int)matrix[i].size() != n)
+                    return false;
+                const int *row = matrix[i].data() + bj;
+                const int *transposed = tile[i - bi];
+                int diff = 0;
+                for (int j = 0; j < jEnd - bj; ++j)
+                    diff |= row[j] ^ transposed[j];
+                if (diff != 0)
+                    return false;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,112 @@
+#include "pool.hpp"
+
+// worker running on the current thread, to send the tasks submitted by a task to its own deque
+static thread_local const TaskPool *currentPool = nullptr;
+static thread_local int currentWorker = -1;
+
+TaskPool::TaskPool(int threads)
+    : queued(0), pending(0), stolen(0), nextWorker(0), stopping(false)
+{
+    int count = threads > 0 ? threads : 1;
+    for (int w = 0; w < count; ++w)
+        workers.push_back(std::unique_ptr<Worker>(new Worker()));
+    for (int w = 0; w < count; ++w)
+        this->threads.push_back(std::thread(&TaskPool::run, this, w));
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(idleLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+int TaskPool::size() const
+{
+    return workers.size();
+}
+
+long TaskPool::steals() const
+{
+    return stolen;
+}
+
+void TaskPool::submit(Task task)
+{
+    int w = currentPool == this ? currentWorker : (int)(nextWorker++ % workers.size());
+    pending++;
+    {
+        std::lock_guard<std::mutex> guard(workers[w]->lock);
+        workers[w]->tasks.push_back(std::move(task));
+    }
+    {
+        // under the lock, so that a worker going to sleep cannot miss it
+        std::lock_guard<std::mutex> guard(idleLock);
+        queued++;
+    }
+    wake.notify_one();
+}
+
+void TaskPool::wait()
+{
+    std::unique_lock<std::mutex> guard(idleLock);
+    idle.wait(guard, [this]() { return pending == 0; });
+}
+
+bool TaskPool::take(int w, Task &task)
+{
+    {
+        Worker &own = *workers[w];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+    for (size_t k = 1; k < workers.size(); ++k)
+    {
+        Worker &victim = *workers[(w + k) % workers.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued--;
+            stolen++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskPool::run(int w)
+{
+    currentPool = this;
+    currentWorker = w;
+    Task task;
+    while (true)
+    {
+        if (take(w, task))
+        {
+            task(w);
+            task = nullptr;
+            if (--pending == 0)
+            {
+                std::lock_guard<std::mutex> guard(idleLock);
+                idle.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(idleLock);
+        wake.wait(guard, [this]() { return stopping || queued > 0; });
+        if (stopping && queued == 0)
+            return;
+    }
+}
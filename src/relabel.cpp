@@ -0,0 +1,70 @@
+#include <fstream>
+#include "heuristic.hpp"
+#include "relabel.hpp"
+#include "tour.hpp"
+
+Relabelling localityRelabelling(const std::vector<std::vector<int>> &c)
+{
+    std::vector<int> succ = nearestNeighbour(c, 0);
+    orOpt(c, succ);
+    Relabelling r;
+    r.original = successorsToTour(succ, 0);
+    r.label.assign(c.size(), -1);
+    for (size_t v = 0; v < r.original.size(); ++v)
+        r.label[r.original[v]] = v;
+    return r;
+}
+
+std::vector<std::vector<int>> relabelMatrix(const std::vector<std::vector<int>> &c, const Relabelling &r)
+{
+    int n = c.size();
+    std::vector<std::vector<int>> relabelled(n, std::vector<int>(n));
+    for (int v = 0; v < n; ++v)
+    {
+        const std::vector<int> &row = c[r.original[v]];
+        for (int w = 0; w < n; ++w)
+            relabelled[v][w] = row[r.original[w]];
+    }
+    return relabelled;
+}
+
+std::vector<int> originalSuccessors(const std::vector<int> &succ, const Relabelling &r)
+{
+    std::vector<int> original(succ.size(), -1);
+    for (size_t v = 0; v < succ.size(); ++v)
+    {
+        if (succ[v] >= 0)
+            original[r.original[v]] = r.original[succ[v]];
+    }
+    return original;
+}
+
+bool writeRelabelling(std::string filePath, const Relabelling &r)
+{
+    std::ofstream file(filePath);
+    if (!file.is_open())
+        return false;
+    for (int city : r.original)
+        file << city << "\n";
+    return file.good();
+}
+
+bool readRelabelling(std::string filePath, Relabelling &r)
+{
+    std::ifstream file(filePath);
+    if (!file.is_open())
+        return false;
+    r.original.clear();
+    int city;
+    while (file >> city)
+        r.original.push_back(city);
+    int n = r.original.size();
+    r.label.assign(n, -1);
+    for (int v = 0; v < n; ++v)
+    {
+        if (r.original[v] < 0 || r.original[v] >= n || r.label[r.original[v]] >= 0)
+            return false;
+        r.label[r.original[v]] = v;
+    }
+    return n > 0;
+}
@@ -0,0 +1,66 @@
+#include "parser.hpp"
+#include "relabel.hpp"
+#include "tour.hpp"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+using namespace std;
+
+// Writes an instance relabelled for locality (see relabel.hpp), which every
+// model reads as any other instance, and the labels: line v of <OUTPUT_FILE>.map
+// is the city of the input instance that the city v of the output stands for,
+// which the models read with --relabel-map to print the original cities.
+//
+// usage : ./relabel.out <PATH_TO_DAT_FILE> <OUTPUT_FILE>
+
+int main(int argc,
+         char *argv[])
+{
+    if (argc != 3)
+    {
+        cerr << "usage : " << argv[0] << " <PATH_TO_DAT_FILE> <OUTPUT_FILE>" << endl;
+        return 1;
+    }
+    vector<vector<int>> c = parse(argv[1]);
+    int n = c.size();
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    Relabelling r = localityRelabelling(c);
+    vector<vector<int>> relabelled = relabelMatrix(c, r);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    ofstream file(argv[2]);
+    if (!file.is_open())
+    {
+        cerr << "File open failed\n"
+             << endl;
+        return 1;
+    }
+    // the parser skips these 7 lines
+    file << "NAME: " << argv[2] << "\n";
+    file << "TYPE: ATSP\n";
+    file << "COMMENT: " << argv[1] << " relabelled along a heuristic tour\n";
+    file << "DIMENSION: " << n << "\n";
+    file << "EDGE_WEIGHT_TYPE: EXPLICIT\n";
+    file << "EDGE_WEIGHT_FORMAT: FULL_MATRIX \n";
+    file << "EDGE_WEIGHT_SECTION\n";
+    string line;
+    for (int i = 0; i < n; ++i)
+    {
+        line.clear();
+        for (int j = 0; j < n; ++j)
+        {
+            line += to_string(relabelled[i][j]);
+            line += ' ';
+        }
+        line += '\n';
+        file << line;
+    }
+    if (!file || !writeRelabelling(string(argv[2]) + ".map", r))
+    {
+        cerr << "Write failed" << endl;
+        return 1;
+    }
+    cout << "Relabelled " << n << " cities in " << seconds << " sec (heuristic tour of cost " << tourCost(c, r.original) << ")" << endl;
+    return 0;
+}
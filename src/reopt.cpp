@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "reopt.hpp"
+#include "parser.hpp"
+#include "subtour.hpp"
+
+std::vector<Delta> readDeltas(std::string filePath)
+{
+    std::ifstream file(filePath);
+    if (!file.is_open())
+    {
+        std::cerr << "Delta file open failed: " << filePath << std::endl;
+        exit(-1);
+    }
+    std::vector<Delta> deltas(1);
+    std::string line;
+    while (getline(file, line))
+    {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        ArcChange change;
+        if (fields >> change.i >> change.j >> change.cost)
+            deltas.back().push_back(change);
+        else if (line.find_first_not_of(" \t\r") == std::string::npos && !deltas.back().empty())
+            deltas.push_back(Delta());
+    }
+    if (deltas.back().empty())
+        deltas.pop_back();
+    return deltas;
+}
+
+void applyDelta(std::vector<std::vector<int>> &c, const Delta &delta)
+{
+    int n = c.size();
+    for (const ArcChange &change : delta)
+    {
+        if (change.i < 0 || change.i >= n || change.j < 0 || change.j >= n || change.i == change.j)
+        {
+            std::cerr << "Invalid arc in delta: " << change.i << " " << change.j << std::endl;
+            exit(-1);
+        }
+        c[change.i][change.j] = std::min(change.cost, forbiddenCost);
+    }
+}
+
+long long deltaSlack(const std::vector<std::vector<int>> &c, const std::vector<Delta> &deltas, std::vector<std::pair<int, int>> &changed)
+{
+    std::vector<std::vector<int>> current = c;
+    long long slack = 0;
+    bool opensOrCloses = false;
+    for (const Delta &delta : deltas)
+    {
+        applyDelta(current, delta);
+        for (const ArcChange &change : delta)
+            changed.push_back(std::make_pair(change.i, change.j));
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+        // the changes of the delta and of the previous ones, against the instance
+        long long sum = 0;
+        for (const std::pair<int, int> &a : changed)
+        {
+            if ((current[a.first][a.second] >= forbiddenCost) != (c[a.first][a.second] >= forbiddenCost))
+                opensOrCloses = true;
+            else if (current[a.first][a.second] < forbiddenCost)
+                sum += std::abs((long long)current[a.first][a.second] - c[a.first][a.second]);
+        }
+        slack = std::max(slack, sum);
+    }
+    return opensOrCloses ? -1 : slack;
+}
+
+int updateCosts(GRBVar *x, const Graph &g, const std::vector<std::vector<int>> &c, const Delta &delta)
+{
+    int modified = 0;
+    for (const ArcChange &change : delta)
+    {
+        int a = g.arc(change.i, change.j);
+        if (a < 0)
+            continue;
+        int cost = c[change.i][change.j];
+        bool closed = cost >= forbiddenCost;
+        x[a].set(GRB_DoubleAttr_Obj, closed ? 0.0 : cost);
+        x[a].set(GRB_DoubleAttr_UB, closed ? 0.0 : 1.0);
+        modified++;
+    }
+    return modified;
+}
+
+void addSubtourConstraints(GRBModel &model, const GRBVar *x, const Graph &g, const std::vector<std::vector<int>> &cuts, size_t from)
+{
+    for (size_t k = from; k < cuts.size(); ++k)
+    {
+        std::stringstream ss;
+        ss << "Subtour(" << k << ")";
+        model.addConstr(insideArcs(g, x, cuts[k]) <= (int)cuts[k].size() - 1, ss.str());
+    }
+}
+
+void addBoundConstraint(GRBModel &model, const GRBVar *x, const Graph &g, double bound)
+{
+    GRBLinExpr cost = 0;
+    for (int a = 0; a < g.m; ++a)
+    {
+        if (g.cost[a] < forbiddenCost)
+            cost += g.cost[a] * x[a];
+    }
+    model.addConstr(cost >= ceil(bound - 1e-6), "Bound");
+}
+
+bool setTourStart(GRBVar *x, const Graph &g, const std::vector<int> &succ, bool symmetric)
+{
+    std::vector<int> arcs;
+    for (int i = 0; i < g.n; ++i)
+    {
+        if (succ[i] < 0)
+            return false;
+        int a = symmetric ? g.arc(std::min(i, succ[i]), std::max(i, succ[i])) : g.arc(i, succ[i]);
+        if (a < 0 || x[a].get(GRB_DoubleAttr_UB) < 0.5)
+            return false;
+        arcs.push_back(a);
+    }
+    for (int a = 0; a < g.m; ++a)
+        x[a].set(GRB_DoubleAttr_Start, 0.0);
+    for (int a : arcs)
+        x[a].set(GRB_DoubleAttr_Start, 1.0);
+    return true;
+}
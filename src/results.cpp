@@ -0,0 +1,71 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+#include "results.hpp"
+
+static std::string trim(std::string s)
+{
+    size_t first = s.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos)
+        return "";
+    size_t last = s.find_last_not_of(" \t\r\n");
+    return s.substr(first, last - first + 1);
+}
+
+// data format (the prefix up to "Result:" is added by grep in results.csv):
+// sol_mtz/log_ftv33.dat.txt:Result: TSP_data//ftv33.dat; runtime = 0.968391 sec; objective value = 1286
+bool parseResultLine(std::string line, RunResult &result)
+{
+    size_t start = line.find("Result:");
+    if (start == std::string::npos)
+        return false;
+    std::string rest = line.substr(start + 7);
+
+    result.fields.clear();
+    result.runtime = 0;
+    result.objective = 0;
+    size_t separator = rest.find(';');
+    std::string path = trim(rest.substr(0, separator));
+    size_t slash = path.find_last_of("/\\");
+    result.instance = slash == std::string::npos ? path : path.substr(slash + 1);
+
+    while (separator != std::string::npos)
+    {
+        size_t next = rest.find(';', separator + 1);
+        std::string field = rest.substr(separator + 1, next == std::string::npos ? std::string::npos : next - separator - 1);
+        size_t equal = field.find('=');
+        if (equal != std::string::npos)
+            result.fields[trim(field.substr(0, equal))] = trim(field.substr(equal + 1));
+        separator = next;
+    }
+
+    if (!result.fields.count("runtime") || !result.fields.count("objective value"))
+        return false;
+    result.runtime = atof(result.fields["runtime"].c_str()); // atof stops before " sec"
+    result.objective = atof(result.fields["objective value"].c_str());
+    return true;
+}
+
+std::vector<RunResult> readResults(std::string path)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+        path += "/results.csv";
+
+    std::vector<RunResult> results;
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        std::cerr << "File open failed: " << path << std::endl;
+        exit(-1);
+    }
+    std::string line;
+    RunResult result;
+    while (std::getline(file, line))
+    {
+        if (parseResultLine(line, result))
+            results.push_back(result);
+    }
+    return results;
+}
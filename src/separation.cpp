@@ -0,0 +1,363 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include "separation.hpp"
+#include "tour.hpp"
+
+std::vector<int> integerSuccessors(const double *x, int n)
+{
+    std::vector<int> succ(n, -1);
+    for (int i = 0; i < n; ++i)
+    {
+        const double *row = x + (size_t)i * n;
+        for (int j = 0; j < n; ++j)
+        {
+            if (row[j] > 0.5)
+            {
+                succ[i] = j;
+                break;
+            }
+        }
+    }
+    return succ;
+}
+
+std::vector<int> subtourFromSolution(const double *x, int n)
+{
+    std::vector<int> S = cycleFrom(integerSuccessors(x, n), 0);
+    if ((int)S.size() == n)
+        S.clear();
+    return S;
+}
+
+std::vector<int> subtourFromRelaxation(const double *x, int n)
+{
+    std::vector<int> succ(n, -1);
+    for (int i = 0; i < n; ++i)
+    {
+        const double *row = x + (size_t)i * n;
+        for (int j = 0; j < n; ++j)
+        {
+            if (row[j] > 0)
+            {
+                succ[i] = j;
+                break;
+            }
+        }
+    }
+    std::vector<int> S = cycleFrom(succ, 0);
+    if ((int)S.size() == n)
+        S.clear();
+    return S;
+}
+
+double subtourLhs(const double *x, int n, const std::vector<int> &S)
+{
+    double lhs = 0;
+    for (int k : S)
+    {
+        for (int l : S)
+        {
+            lhs += x[(size_t)k * n + l];
+        }
+    }
+    return lhs;
+}
+
+std::vector<std::vector<int>> edgeComponents(const double *x, int n)
+{
+    std::vector<std::vector<int>> neighbours(n);
+    for (int i = 0; i < n; ++i)
+    {
+        const double *row = x + (size_t)i * n;
+        for (int j = i + 1; j < n; ++j)
+        {
+            if (row[j] > 0.5)
+            {
+                neighbours[i].push_back(j);
+                neighbours[j].push_back(i);
+            }
+        }
+    }
+
+    std::vector<std::vector<int>> components;
+    std::vector<char> seen(n, 0);
+    std::vector<int> stack;
+    for (int start = 0; start < n; ++start)
+    {
+        if (seen[start])
+            continue;
+        std::vector<int> component;
+        seen[start] = 1;
+        stack.push_back(start);
+        while (!stack.empty())
+        {
+            int i = stack.back();
+            stack.pop_back();
+            component.push_back(i);
+            for (int j : neighbours[i])
+            {
+                if (!seen[j])
+                {
+                    seen[j] = 1;
+                    stack.push_back(j);
+                }
+            }
+        }
+        components.push_back(component);
+    }
+    return components;
+}
+
+double liftedCycleLhs(const double *x, int n, const std::vector<int> &sequence, bool plus)
+{
+    std::vector<std::pair<int, int>> arcs;
+    std::vector<int> coefficients;
+    liftedCycleCoefficients(sequence, plus, arcs, coefficients);
+    double lhs = 0;
+    for (size_t a = 0; a < arcs.size(); ++a)
+        lhs += coefficients[a] * x[(size_t)arcs[a].first * n + arcs[a].second];
+    return lhs;
+}
+
+void liftedCycleCoefficients(const std::vector<int> &sequence, bool plus, std::vector<std::pair<int, int>> &arcs, std::vector<int> &coefficients)
+{
+    const std::vector<int> &s = sequence; // 0-based: s[0] is i1
+    int k = s.size();
+    arcs.clear();
+    coefficients.clear();
+    for (int h = 0; h < k; ++h)
+    {
+        arcs.push_back(std::make_pair(s[h], s[(h + 1) % k]));
+        coefficients.push_back(1);
+    }
+    for (int h = plus ? 2 : 1; h < (plus ? k : k - 1); ++h)
+    {
+        arcs.push_back(plus ? std::make_pair(s[0], s[h]) : std::make_pair(s[h], s[0]));
+        coefficients.push_back(2);
+    }
+    for (int h = plus ? 3 : 2; h < (plus ? k : k - 1); ++h)
+    {
+        for (int j = plus ? 2 : 1; j < h; ++j)
+        {
+            arcs.push_back(std::make_pair(s[h], s[j]));
+            coefficients.push_back(1);
+        }
+    }
+}
+
+// state of the depth-first search of liftedCycleViolations
+struct LiftedCycleSearch
+{
+    const double *x;
+    int n, maxLength;
+    std::vector<std::vector<int>> support; ///< heads of the positive arcs of each city, heaviest first
+    std::vector<int> path;
+    std::vector<char> onPath;
+    std::vector<LiftedCycleCut> cuts;
+    std::chrono::steady_clock::time_point deadline;
+    long steps;
+    bool stopped;
+
+    double at(int i, int j) const { return x[(size_t)i * n + j]; }
+
+    // path weight and the lifting terms that only depend on the cities of the
+    // path (for D_k-, the terms of the last city come with the next one)
+    void extend(double weight, double plusLift, double minusLift)
+    {
+        if (++steps % 256 == 0 && std::chrono::steady_clock::now() > deadline)
+            stopped = true;
+        if (stopped)
+            return;
+        int k = path.size();
+        const std::vector<int> &s = path;
+        if (k >= 3)
+        {
+            double closing = at(s[k - 1], s[0]);
+            double violation = weight + closing + plusLift - (k - 1);
+            if (violation > 1e-3)
+                record(true, violation);
+            violation = weight + closing + minusLift - (k - 1);
+            if (violation > 1e-3)
+                record(false, violation);
+        }
+        if (k == maxLength)
+            return;
+
+        // terms of D_k- for the city s[k-1], which is no longer the last one
+        double minusNext = minusLift;
+        if (k - 1 >= 1)
+            minusNext += 2 * at(s[k - 1], s[0]);
+        for (int j = 1; j <= k - 2; ++j)
+            minusNext += at(s[k - 1], s[j]);
+
+        for (int v : support[s[k - 1]])
+        {
+            if (onPath[v])
+                continue;
+            double w = weight + at(s[k - 1], v);
+            double plusNext = plusLift;
+            if (k >= 2)
+                plusNext += 2 * at(s[0], v);
+            for (int j = 2; j < k; ++j)
+                plusNext += at(v, s[j]);
+            // the lifted weight of the path must stay within 1 of its k arcs,
+            // the closing arc bringing at most 1
+            if (k - (w + std::max(plusNext, minusNext)) >= 1.0)
+                continue;
+            path.push_back(v);
+            onPath[v] = 1;
+            extend(w, plusNext, minusNext);
+            onPath[v] = 0;
+            path.pop_back();
+            if (stopped)
+                return;
+        }
+    }
+
+    void record(bool plus, double violation)
+    {
+        LiftedCycleCut cut;
+        cut.sequence = path;
+        cut.plus = plus;
+        cut.violation = violation;
+        cuts.push_back(cut);
+    }
+};
+
+static bool moreViolated(const LiftedCycleCut &a, const LiftedCycleCut &b)
+{
+    return a.violation > b.violation;
+}
+
+std::vector<LiftedCycleCut> liftedCycleViolations(const double *x, int n, int maxLength, double budget, int maxCuts)
+{
+    LiftedCycleSearch search;
+    search.x = x;
+    search.n = n;
+    search.maxLength = std::min(maxLength, n - 1); // a cycle through every city is not a subtour
+    search.support.resize(n);
+    for (int i = 0; i < n; ++i)
+    {
+        std::vector<std::pair<double, int>> heads;
+        for (int j = 0; j < n; ++j)
+        {
+            if (j != i && x[(size_t)i * n + j] > 1e-6)
+                heads.push_back(std::make_pair(-x[(size_t)i * n + j], j));
+        }
+        std::sort(heads.begin(), heads.end());
+        for (const std::pair<double, int> &head : heads)
+            search.support[i].push_back(head.second);
+    }
+    search.onPath.assign(n, 0);
+    search.deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(budget));
+    search.steps = 0;
+    search.stopped = false;
+
+    for (int start = 0; start < n && !search.stopped; ++start)
+    {
+        search.path.assign(1, start);
+        search.onPath[start] = 1;
+        search.extend(0.0, 0.0, 0.0);
+        search.onPath[start] = 0;
+    }
+
+    std::vector<LiftedCycleCut> &cuts = search.cuts;
+    if ((int)cuts.size() > maxCuts)
+    {
+        std::partial_sort(cuts.begin(), cuts.begin() + maxCuts, cuts.end(), moreViolated);
+        cuts.resize(maxCuts);
+    }
+    else
+        std::sort(cuts.begin(), cuts.end(), moreViolated);
+    return cuts;
+}
+
+bool flotArc(int i, int j, int k, int n)
+{
+    return i != j && (i == 0 || k != 0) && (i != 0 || k == 0) && (j == 0 || k != n - 1) && (j != 0 || k == n - 1);
+}
+
+std::vector<FlotCut> flotLinkingViolations(const double *x, int n)
+{
+    std::vector<FlotCut> cuts;
+    // out(j, k) = sum_l x(j,l,k): the right-hand side for a given i is out(j, k+1)
+    // minus x(j,i,k+1), which avoids summing over l again for every i
+    std::vector<double> out((size_t)n * n, 0.0);
+    for (int j = 0; j < n; ++j)
+    {
+        for (int l = 0; l < n; ++l)
+        {
+            const double *arc = x + ((size_t)j * n + l) * n;
+            for (int k = 0; k < n; ++k)
+            {
+                if (flotArc(j, l, k, n))
+                    out[(size_t)j * n + k] += arc[k];
+            }
+        }
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            for (int k = 1; k < n - 2; ++k)
+            {
+                if (!flotArc(i, j, k, n))
+                    continue;
+                double inVal = out[(size_t)j * n + k + 1];
+                if (flotArc(j, i, k + 1, n))
+                    inVal -= x[((size_t)j * n + i) * n + k + 1];
+                double xVal = x[((size_t)i * n + j) * n + k];
+                if (xVal > inVal + 1e-6) // inVal may be slightly negative on arcs out of the graph
+                {
+                    FlotCut cut = {i, j, k, xVal - inVal};
+                    cuts.push_back(cut);
+                }
+            }
+        }
+    }
+    return cuts;
+}
+
+void writeRelaxation(std::string filePath, const std::vector<double> &x, int n, int dims)
+{
+    std::ofstream file(filePath);
+    if (!file.is_open())
+    {
+        std::cerr << "Cannot write relaxation to " << filePath << std::endl;
+        return;
+    }
+    file.precision(17);
+    file << n << " " << dims << "\n";
+    for (size_t idx = 0; idx < x.size(); ++idx)
+    {
+        if (x[idx] != 0)
+            file << idx << " " << x[idx] << "\n";
+    }
+}
+
+std::vector<double> readRelaxation(std::string filePath, int &n, int &dims)
+{
+    std::ifstream file(filePath);
+    if (!file.is_open())
+    {
+        std::cerr << "File open failed\n"
+                  << std::endl;
+        exit(-1);
+    }
+    file >> n >> dims;
+    size_t size = 1;
+    for (int d = 0; d < dims; ++d)
+        size *= n;
+    std::vector<double> x(size, 0.0);
+    size_t idx;
+    double value;
+    while (file >> idx >> value)
+    {
+        if (idx < size)
+            x[idx] = value;
+    }
+    return x;
+}
@@ -0,0 +1,636 @@
+#include "gurobi_c++.h"
+#include "config.hpp"
+#include "json.hpp"
+#include "lns.hpp"
+#include "parser.hpp"
+#include "pool.hpp"
+#include "subtour.hpp"
+#include "tour.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+using namespace std;
+
+// Solver service: a long-running process answering solve requests with the
+// subtour model (see subtour.hpp), so that the Gurobi environments and the
+// parsed instances are reused from one request to the next instead of being
+// rebuilt by a new process each time as benchmark.sh does.
+//
+// usage : ./service.out <SOCKET_PATH | -> [-nv] [--workers=N] [--queue=64] [--cache=16] [--time-limit=60]
+//
+// With "-" the requests are read from stdin and answered on stdout, otherwise
+// the service listens on a Unix domain socket, each connection being a client.
+// A request is one line, either an instance path or a JSON object:
+//   {"id": "a", "path": "TSP_data/ftv33.dat", "time_limit": 10}
+//   {"id": "b", "matrix": [[100000000, 3, 5], [4, 100000000, 1], [2, 6, 100000000]]}
+//   {"cancel": "a"}    stops the request a, queued or running
+//   {"stats": true}    counters, throughput and latency percentiles
+//   {"shutdown": true} answers the requests in flight and stops
+// Each solve request gets one JSON line in return, in completion order:
+//   {"id": "a", "status": "optimal", "objective": 1286, "tour": [0, ...], "queue_time": ..., "solve_time": ..., "latency": ...}
+// where the status is optimal, feasible (time limit), cancelled, rejected
+// (queue full) or error. Logs go to stderr, stdout may carry the responses.
+
+typedef vector<vector<int>> Matrix;
+typedef chrono::steady_clock Clock;
+
+static double seconds(Clock::time_point from, Clock::time_point to)
+{
+    return chrono::duration<double>(to - from).count();
+}
+
+static string trim(string s)
+{
+    size_t first = s.find_first_not_of(" \t\r\n");
+    if (first == string::npos)
+        return "";
+    size_t last = s.find_last_not_of(" \t\r\n");
+    return s.substr(first, last - first + 1);
+}
+
+// where the responses of a client go, shared by its requests in flight: the
+// connection is closed when the last of them is answered
+class Channel
+{
+public:
+    explicit Channel(int _fd) : fd(_fd), open(true) {}
+    ~Channel()
+    {
+        if (fd > STDERR_FILENO)
+            close(fd);
+    }
+
+    void send(const string &line)
+    {
+        lock_guard<mutex> guard(lock);
+        string data = line + "\n";
+        size_t written = 0;
+        while (open && written < data.size())
+        {
+            ssize_t w = write(fd, data.data() + written, data.size() - written);
+            if (w <= 0)
+                open = false; //< the client is gone, its responses are dropped
+            else
+                written += w;
+        }
+    }
+
+private:
+    int fd;
+    mutex lock;
+    bool open;
+};
+
+// instances read from files, kept while the file keeps its size and
+// modification time; the least recently used one is evicted first
+class InstanceCache
+{
+public:
+    explicit InstanceCache(size_t _capacity) : capacity(_capacity) {}
+
+    shared_ptr<const Matrix> get(const string &path, bool &hit, string &error)
+    {
+        hit = false;
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+        {
+            error = "cannot open " + path;
+            return nullptr;
+        }
+        {
+            lock_guard<mutex> guard(lock);
+            for (list<Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+            {
+                if (it->path == path && it->mtime == info.st_mtime && it->size == info.st_size)
+                {
+                    entries.splice(entries.begin(), entries, it);
+                    hit = true;
+                    return it->c;
+                }
+            }
+        }
+
+        // parse() prints to stdout and exits on failure: the file is read here
+        ifstream file(path);
+        if (!file.is_open())
+        {
+            error = "cannot open " + path;
+            return nullptr;
+        }
+        shared_ptr<const Matrix> c = make_shared<const Matrix>(processFile(file));
+        Entry entry = {path, info.st_mtime, info.st_size, c};
+        lock_guard<mutex> guard(lock);
+        entries.remove_if([&path](const Entry &e) { return e.path == path; });
+        entries.push_front(entry);
+        if (entries.size() > capacity)
+            entries.pop_back();
+        return c;
+    }
+
+private:
+    struct Entry
+    {
+        string path;
+        time_t mtime;
+        off_t size;
+        shared_ptr<const Matrix> c;
+    };
+    list<Entry> entries;
+    mutex lock;
+    size_t capacity;
+};
+
+struct Request
+{
+    string id;
+    shared_ptr<const Matrix> c;
+    double timeLimit;
+    bool cached;
+    Clock::time_point received;
+    shared_ptr<atomic<bool>> cancel;
+    shared_ptr<Channel> channel;
+};
+
+class Service
+{
+public:
+    explicit Service(const Config &config);
+    ~Service();
+
+    // handles one line of a client; false when it asks the service to stop
+    bool handle(const string &line, const shared_ptr<Channel> &channel);
+    // waits until every request in flight is answered
+    void drain();
+    string statsJson();
+
+private:
+    TaskPool pool;
+    vector<GRBEnv *> envs; ///< one per worker, reused by all its solves
+    InstanceCache cache;
+    size_t queueLimit;
+    double maxTime;
+    bool verbose;
+    Clock::time_point start;
+
+    mutex flightLock;
+    map<string, shared_ptr<atomic<bool>>> inFlight; ///< cancellation flag of each request queued or running
+    long sequence;
+
+    mutex statsLock;
+    long received, completed, optimal, cancelled, rejected, errors, cacheHits;
+    vector<double> latencies; ///< ring of the latest latencies
+    size_t nextLatency;
+
+    void solve(const Request &request, int worker);
+    void finish(const Request &request, const string &response, const string &status);
+    void reply(const shared_ptr<Channel> &channel, const string &id, const string &status, const string &error);
+};
+
+static const size_t latencyWindow = 100000;
+
+Service::Service(const Config &config)
+    : pool(max(1, (int)config.number("workers", config.threads))),
+      cache((size_t)max(1.0, config.number("cache", 16))),
+      queueLimit((size_t)max(1.0, config.number("queue", 64))),
+      maxTime(config.timeLimit),
+      verbose(config.verbose),
+      start(Clock::now()),
+      sequence(0),
+      received(0), completed(0), optimal(0), cancelled(0), rejected(0), errors(0), cacheHits(0),
+      nextLatency(0)
+{
+    for (int w = 0; w < pool.size(); ++w)
+    {
+        envs.push_back(new GRBEnv(true));
+        envs.back()->set(GRB_IntParam_OutputFlag, 0);
+        envs.back()->start();
+    }
+}
+
+Service::~Service()
+{
+    drain();
+    for (GRBEnv *env : envs)
+        delete env;
+}
+
+void Service::drain()
+{
+    pool.wait();
+}
+
+static string idOf(const JsonValue &value)
+{
+    if (value.type == JsonValue::STRING)
+        return value.text;
+    if (value.type == JsonValue::NUMBER)
+    {
+        stringstream ss;
+        ss << value.number;
+        return ss.str();
+    }
+    return "";
+}
+
+void Service::reply(const shared_ptr<Channel> &channel, const string &id, const string &status, const string &error)
+{
+    stringstream out;
+    out << "{\"id\":" << jsonString(id) << ",\"status\":\"" << status << "\"";
+    if (!error.empty())
+        out << ",\"error\":" << jsonString(error);
+    out << "}";
+    channel->send(out.str());
+}
+
+bool Service::handle(const string &text, const shared_ptr<Channel> &channel)
+{
+    string line = trim(text);
+    if (line.empty())
+        return true;
+
+    JsonValue message;
+    string error;
+    if (line[0] != '{')
+    {
+        // a bare instance path
+        message.type = JsonValue::OBJECT;
+        message.members["path"].type = JsonValue::STRING;
+        message.members["path"].text = line;
+    }
+    else if (!parseJson(line, message, error) || message.type != JsonValue::OBJECT)
+    {
+        reply(channel, "", "error", error.empty() ? "a request is a JSON object" : error);
+        return true;
+    }
+
+    if (message.has("shutdown"))
+    {
+        reply(channel, idOf(message["id"]), "stopping", "");
+        return false;
+    }
+    if (message.has("stats"))
+    {
+        channel->send(statsJson());
+        return true;
+    }
+    if (message.has("cancel"))
+    {
+        string target = idOf(message["cancel"]);
+        lock_guard<mutex> guard(flightLock);
+        map<string, shared_ptr<atomic<bool>>>::iterator it = inFlight.find(target);
+        if (it == inFlight.end())
+            reply(channel, target, "error", "no such request in flight");
+        else
+        {
+            it->second->store(true);
+            reply(channel, target, "cancelling", "");
+        }
+        return true;
+    }
+
+    Request request;
+    request.received = Clock::now();
+    request.channel = channel;
+    request.cancel = make_shared<atomic<bool>>(false);
+    request.cached = false;
+    request.id = idOf(message["id"]);
+    if (request.id.empty())
+    {
+        lock_guard<mutex> guard(flightLock);
+        request.id = to_string(++sequence);
+    }
+    request.timeLimit = maxTime;
+    if (message["time_limit"].type == JsonValue::NUMBER)
+        request.timeLimit = min(maxTime, max(0.0, message["time_limit"].number));
+    {
+        lock_guard<mutex> guard(statsLock);
+        received++;
+    }
+
+    if (message["path"].type == JsonValue::STRING)
+    {
+        request.c = cache.get(message["path"].text, request.cached, error);
+        lock_guard<mutex> guard(statsLock);
+        cacheHits += request.cached;
+    }
+    else if (message["matrix"].type == JsonValue::ARRAY)
+    {
+        const vector<JsonValue> &rows = message["matrix"].items;
+        shared_ptr<Matrix> c = make_shared<Matrix>(rows.size());
+        for (size_t i = 0; i < rows.size() && error.empty(); ++i)
+        {
+            for (const JsonValue &value : rows[i].items)
+            {
+                // costs at least forbiddenCost close the arc, as in the instance files
+                double cost = value.number;
+                if (value.type != JsonValue::NUMBER || !isfinite(cost) || cost < 0 || cost != floor(cost))
+                {
+                    error = "the matrix holds non-negative integers only";
+                    break;
+                }
+                (*c)[i].push_back((int)min((double)forbiddenCost, cost));
+            }
+        }
+        request.c = c;
+    }
+    else
+        error = "a request needs a path or a matrix";
+
+    if (error.empty())
+    {
+        int n = request.c->size();
+        if (n < 2)
+            error = "an instance needs at least 2 cities";
+        for (int i = 0; i < n && error.empty(); ++i)
+        {
+            if ((int)(*request.c)[i].size() != n)
+                error = "the matrix is not square";
+        }
+    }
+    if (!error.empty())
+    {
+        {
+            lock_guard<mutex> guard(statsLock);
+            errors++;
+        }
+        reply(channel, request.id, "error", error);
+        return true;
+    }
+
+    // bounded queue: a request beyond the limit is rejected at once, so that the
+    // client can retry later or elsewhere instead of waiting without bound
+    {
+        lock_guard<mutex> guard(flightLock);
+        if (inFlight.count(request.id))
+            error = "a request with this id is already in flight";
+        else if (inFlight.size() >= queueLimit)
+            error = "queue full";
+        else
+            inFlight[request.id] = request.cancel;
+    }
+    if (!error.empty())
+    {
+        {
+            lock_guard<mutex> guard(statsLock);
+            rejected++;
+        }
+        reply(channel, request.id, "rejected", error);
+        return true;
+    }
+    if (verbose)
+        cerr << "--> Request " << request.id << ": " << request.c->size() << " cities" << (request.cached ? " (cached)" : "") << endl;
+    pool.submit([this, request](int worker) { solve(request, worker); });
+    return true;
+}
+
+void Service::solve(const Request &request, int worker)
+{
+    Clock::time_point started = Clock::now();
+    const Matrix &c = *request.c;
+    string status = "cancelled", error;
+    vector<int> succ;
+    long long lowerBound = -1;
+    if (!request.cancel->load())
+    {
+        try
+        {
+            succ = startingTour(c, lowerBound);
+            bool proven = false;
+            solveSubtour(*envs[worker], c, request.timeLimit, succ, proven, request.cancel.get());
+            status = proven ? "optimal" : request.cancel->load() ? "cancelled" : "feasible";
+        }
+        catch (GRBException e)
+        {
+            status = "error";
+            error = e.getMessage();
+        }
+        catch (...)
+        {
+            status = "error";
+            error = "exception during optimization";
+        }
+    }
+    Clock::time_point finished = Clock::now();
+
+    stringstream out;
+    out << "{\"id\":" << jsonString(request.id) << ",\"status\":\"" << status << "\"";
+    if (!error.empty())
+        out << ",\"error\":" << jsonString(error);
+    if (!succ.empty())
+    {
+        // the best tour found, also when the request is cancelled or out of time
+        out << ",\"objective\":" << successorCost(c, succ);
+        if (lowerBound >= 0)
+            out << ",\"lower_bound\":" << lowerBound;
+        out << ",\"tour\":[";
+        vector<int> tour = successorsToTour(succ);
+        for (size_t k = 0; k < tour.size(); ++k)
+            out << (k ? "," : "") << tour[k];
+        out << "]";
+    }
+    out << ",\"queue_time\":" << seconds(request.received, started)
+        << ",\"solve_time\":" << seconds(started, finished)
+        << ",\"latency\":" << seconds(request.received, finished)
+        << ",\"worker\":" << worker
+        << ",\"cached\":" << (request.cached ? "true" : "false") << "}";
+    finish(request, out.str(), status);
+}
+
+void Service::finish(const Request &request, const string &response, const string &status)
+{
+    {
+        lock_guard<mutex> guard(flightLock);
+        inFlight.erase(request.id);
+    }
+    {
+        lock_guard<mutex> guard(statsLock);
+        completed++;
+        optimal += status == "optimal";
+        cancelled += status == "cancelled";
+        errors += status == "error";
+        double latency = seconds(request.received, Clock::now());
+        if (latencies.size() < latencyWindow)
+            latencies.push_back(latency);
+        else
+            latencies[nextLatency] = latency;
+        nextLatency = (nextLatency + 1) % latencyWindow;
+    }
+    request.channel->send(response);
+}
+
+static double percentile(vector<double> &values, double p)
+{
+    if (values.empty())
+        return 0;
+    size_t k = min(values.size() - 1, (size_t)(p * values.size()));
+    nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+string Service::statsJson()
+{
+    size_t flying;
+    {
+        lock_guard<mutex> guard(flightLock);
+        flying = inFlight.size();
+    }
+    lock_guard<mutex> guard(statsLock);
+    double uptime = seconds(start, Clock::now());
+    vector<double> sorted = latencies;
+    double mean = 0;
+    for (double latency : sorted)
+        mean += latency;
+    if (!sorted.empty())
+        mean /= sorted.size();
+
+    stringstream out;
+    out << "{\"stats\":{\"uptime\":" << uptime
+        << ",\"received\":" << received << ",\"completed\":" << completed
+        << ",\"optimal\":" << optimal << ",\"cancelled\":" << cancelled
+        << ",\"rejected\":" << rejected << ",\"errors\":" << errors
+        << ",\"in_flight\":" << flying
+        << ",\"throughput\":" << (uptime > 0 ? completed / uptime : 0.0)
+        << ",\"latency_mean\":" << mean
+        << ",\"latency_p50\":" << percentile(sorted, 0.50)
+        << ",\"latency_p95\":" << percentile(sorted, 0.95)
+        << ",\"latency_p99\":" << percentile(sorted, 0.99)
+        << ",\"latency_max\":" << (sorted.empty() ? 0.0 : *max_element(sorted.begin(), sorted.end()))
+        << ",\"cache_hits\":" << cacheHits
+        << ",\"workers\":" << pool.size() << ",\"steals\":" << pool.steals() << "}}";
+    return out.str();
+}
+
+static void serveStdin(Service &service)
+{
+    shared_ptr<Channel> channel = make_shared<Channel>(STDOUT_FILENO);
+    string line;
+    while (getline(cin, line) && service.handle(line, channel))
+    {
+    }
+}
+
+static void serveSocket(Service &service, const string &path, bool verbose)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        cerr << "Socket path too long: " << path << endl;
+        exit(-1);
+    }
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path.c_str());
+    if (listener < 0 || bind(listener, (sockaddr *)&address, sizeof(address)) < 0 || listen(listener, 64) < 0)
+    {
+        cerr << "Socket bind failed: " << path << endl;
+        exit(-1);
+    }
+    if (verbose)
+        cerr << "--> Listening on " << path << endl;
+
+    atomic<bool> stopping(false);
+    mutex clientsLock;
+    set<int> clients; ///< connections still read, shut down at the end
+    map<long, thread> readers;
+    vector<long> finished; ///< readers whose connection is closed, joined at the next accept
+    long nextReader = 0;
+    while (!stopping)
+    {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0)
+        {
+            if (errno == EINTR && !stopping)
+                continue;
+            break;
+        }
+        vector<long> done;
+        {
+            lock_guard<mutex> guard(clientsLock);
+            clients.insert(fd);
+            done.swap(finished);
+        }
+        for (long id : done)
+        {
+            readers[id].join();
+            readers.erase(id);
+        }
+        long id = nextReader++;
+        readers[id] = thread([&service, &stopping, &clientsLock, &clients, &finished, listener, fd, id]() {
+            shared_ptr<Channel> channel = make_shared<Channel>(fd);
+            string buffer;
+            char chunk[4096];
+            ssize_t r;
+            bool running = true;
+            while (running && (r = read(fd, chunk, sizeof(chunk))) > 0)
+            {
+                buffer.append(chunk, r);
+                size_t end;
+                while (running && (end = buffer.find('\n')) != string::npos)
+                {
+                    string line = buffer.substr(0, end);
+                    buffer.erase(0, end + 1);
+                    if (!service.handle(line, channel))
+                    {
+                        running = false;
+                        stopping = true;
+                        shutdown(listener, SHUT_RDWR); //< wakes up accept
+                    }
+                }
+            }
+            if (running && !buffer.empty())
+                service.handle(buffer, channel);
+            lock_guard<mutex> guard(clientsLock);
+            clients.erase(fd);
+            finished.push_back(id);
+        });
+    }
+    {
+        lock_guard<mutex> guard(clientsLock);
+        for (int fd : clients)
+            shutdown(fd, SHUT_RD);
+    }
+    for (pair<const long, thread> &reader : readers)
+        reader.second.join();
+    close(listener);
+    unlink(path.c_str());
+}
+
+int main(int argc,
+         char *argv[])
+{
+    Config config = parseArgs(argc, argv, 60.0);
+    signal(SIGPIPE, SIG_IGN); //< a client leaving early must not stop the service
+
+    try
+    {
+        Service service(config);
+        if (config.instance == "-")
+            serveStdin(service);
+        else
+            serveSocket(service, config.instance, config.verbose);
+        service.drain();
+        cout << service.statsJson() << endl;
+    }
+    catch (GRBException e)
+    {
+        cerr << "Error code = " << e.getErrorCode() << endl;
+        cerr << e.getMessage() << endl;
+    }
+    return 0;
+}
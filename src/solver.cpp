@@ -0,0 +1,76 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+#include "memory.hpp"
+#include "solver.hpp"
+
+std::string sizeClass(int n)
+{
+    int low = 1;
+    while (low * 2 <= n)
+        low *= 2;
+    std::stringstream ss;
+    ss << "n" << low << "-" << 2 * low - 1;
+    return ss.str();
+}
+
+static void applySettings(GRBModel &model, const Config &config)
+{
+    model.set(GRB_DoubleParam_TimeLimit, config.timeLimit); //< sets the time limit (in seconds)
+    model.set(GRB_IntParam_Threads, config.threads);        //< limits the number of threads
+    for (std::map<std::string, std::string>::const_iterator it = config.params.begin(); it != config.params.end(); ++it)
+    {
+        model.set(it->first, it->second);
+    }
+}
+
+static void tune(GRBModel &model, const Config &config, std::string formulation, int n)
+{
+    std::string directory = config.get("tune-cache", "tune_cache");
+    std::string cache = directory + "/" + formulation + "_" + sizeClass(n) + ".prm";
+
+    std::ifstream cached(cache);
+    if (cached.is_open())
+    {
+        if (config.verbose)
+            std::cout << "--> Using the tuned parameters of " << cache << std::endl;
+        model.read(cache);
+        return;
+    }
+
+    if (config.verbose)
+        std::cout << "--> Tuning the solver, the result goes to " << cache << std::endl;
+    model.set(GRB_DoubleParam_TuneTimeLimit, config.number("tune-time", 120.0));
+    model.set(GRB_IntParam_TuneResults, 1);
+    model.tune();
+    if (model.get(GRB_IntAttr_TuneResultCount) > 0)
+    {
+        model.getTuneResult(0); //< loads the best parameter set into the model
+        mkdir(directory.c_str(), 0755);
+        model.write(cache);
+    }
+}
+
+void configure(GRBModel &model, const Config &config, std::string formulation, int n)
+{
+    if (config.has("tune"))
+    {
+        applySettings(model, config);
+        tune(model, config, formulation, n);
+    }
+    // explicit settings win over the tuned ones
+    applySettings(model, config);
+}
+
+std::string resourceFields(GRBModel &model)
+{
+    std::stringstream ss;
+    int status = model.get(GRB_IntAttr_Status);
+    ss << "status = " << (status == GRB_OPTIMAL ? "optimal" : status == GRB_TIME_LIMIT ? "time limit" : status == GRB_INTERRUPTED ? "interrupted" : std::to_string(status)) << "; ";
+    ss << "vars = " << model.get(GRB_IntAttr_NumVars) << "; ";
+    ss << "constrs = " << model.get(GRB_IntAttr_NumConstrs) << "; ";
+    ss << "nonzeros = " << model.get(GRB_DoubleAttr_DNumNZs) << "; ";
+    ss << memoryFields();
+    return ss.str();
+}
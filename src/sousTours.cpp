@@ -1,92 +1,298 @@
 #include "gurobi_c++.h"
+#include "checkpoint.hpp"
+#include "cutlib.hpp"
+#include "graph.hpp"
+#include "lns.hpp"
+#include "multistart.hpp"
 #include "parser.hpp"
+#include "reopt.hpp"
+#include "memory.hpp"
+#include "solver.hpp"
+#include "subtour.hpp"
+#include "tour.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
 #include <stack>
 #include <cstring>
 using namespace std;
 
-class Callback : public GRBCallback
+// --lns: large neighbourhood search with the model as repair operator (see lns.hpp),
+// for the instances too large to be solved to optimality within the time limit
+static int runLns(const vector<vector<int>> &c, const Config &config)
 {
-public:
-    GRBVar **x;
-    int n;
-
-    /**
-       The constructor is used to get a pointer to the variables that are needed.
-     */
-    Callback(GRBVar **_x, int _n)
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int n = c.size();
+    long long lowerBound;
+    // --balas=<k>: Balas-Simonetti search on the starting tour and each improved one (see balas.hpp)
+    int polish = (int)config.number("balas", 0);
+    vector<int> succ = startingTour(c, lowerBound, polish);
+    if (config.verbose)
+        cout << "--> Starting tour: " << successorCost(c, succ) << endl;
+
+    LnsOptions options;
+    options.timeLimit = config.timeLimit;
+    options.threads = config.threads;
+    options.repairLimit = config.number("lns-repair", 1.0);
+    options.window = (int)config.number("lns-window", 30);
+    options.seed = (unsigned)config.number("seed", 1);
+    options.polish = polish;
+    options.verbose = config.verbose;
+    Trace trace;
+    LnsStats stats;
+    try
+    {
+        succ = lns(c, succ, lowerBound, options, trace, stats);
+    }
+    catch (GRBException e)
     {
-        x = _x;
-        n = _n;
+        cout << "Error code = " << e.getErrorCode() << endl;
+        cout << e.getMessage() << endl;
+        return 0;
     }
 
-protected:
-    void callback()
+    string tracePath = config.get("trace");
+    if (!tracePath.empty() && !trace.writeCsv(tracePath))
+        cerr << "Trace write failed: " << tracePath << endl;
+    if (config.verbose)
     {
-        try
+        // improvement curve: time (sec) and cost of the tour
+        for (const TracePoint &point : trace.points())
+            cout << point.time << " " << point.incumbent << endl;
+    }
+
+    cout << "Result: ";
+    cout << config.instance << "; ";
+    cout << "runtime = " << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " sec; ";
+    cout << "objective value = " << successorCost(c, succ) << "; ";
+    cout << "primal-dual integral = " << trace.primalDualIntegral() << "; ";
+    cout << "lns rounds = " << stats.rounds << "; repairs = " << stats.repairs << "; improvements = " << stats.improvements << "; ";
+    cout << "repair timeouts = " << stats.timeouts << "; window = " << stats.window << endl;
+
+    if (config.verbose)
+    {
+        for (int i = 0, step = 0; step < n; ++step)
         {
-            if (where == GRB_CB_MIPSOL)
-            {
-                vector<int> indices;
-                GRBLinExpr tour = 0;
-                int taille = 0;
-                int i = 0;
-                for (size_t j = 0; j < n; ++j)
-                {
-                    double xVal = getSolution(x[i][j]);
-                    if (xVal > 0.5)
-                    {
-                        indices.push_back(i);
-                        // tour += x[i][j];
-                        taille += 1;
-                        i = j;
-                        if (i == 0)
-                            break;
-                        j = -1;
-                    }
-                }
-                // cout << endl  << "#######" << taille << "#######" << endl;
-                if (taille < n)
-                { // sous-tour existe
-                    // cout << tour << endl;
-                    // cout << "Constraint not satisfied : sous tour de taille " << taille << " existe. Adding this constraint." << endl;
-                    for (int k : indices)
-                    {
-                        for (int l : indices)
-                        {
-                            tour += x[k][l];
-                        }
-                    }
-                    addLazy(tour <= taille - 1);
-                }
-            }
+            cout << "ville " << i << " --> "
+                 << "ville " << succ[i] << endl;
+            i = succ[i];
         }
-        catch (GRBException e)
+    }
+    return 0;
+}
+
+// solves the model with a new callback and prints its result line, starting
+// with label and ending with extra. The state holds what the previous solves
+// found (see checkpoint.hpp): the tour, bound, time and subtour constraints of
+// this one are added to it. Returns the tour (empty if none was found).
+static vector<int> solveModel(GRBModel &model, GRBVar *x, const Graph &g, bool symmetric, const Config &config,
+                              string label, string extra, Checkpoint &state)
+{
+    bool verbose = config.verbose;
+    int n = g.n;
+
+    // Callback
+    ModelCallback *cb; // passing variable x to the solver callback
+    if (symmetric)
+        cb = new UndirectedSubtourCallback(x, &g);
+    else
+        cb = new SubtourCallback(x, &g);
+    model.setCallback(cb); // adding the callback to the model
+    cb->watch(config, ArcVariables(&g, x, symmetric), state.instance); //< --incumbents, --stop-file and --checkpoint
+    cb->resume(state);
+
+    // --- Solver launch ---
+    if (verbose)
+        cout << "--> Running the solver" << endl;
+    model.optimize();
+    finishCallback(model, *cb, config);
+    // model.write("model.lp"); //< Writes the model in a file
+    const vector<vector<int>> &found = symmetric ? ((UndirectedSubtourCallback *)cb)->cuts : ((SubtourCallback *)cb)->cuts;
+    state.subtours.insert(state.subtours.end(), found.begin(), found.end());
+    state.runtime = cb->totalRuntime(model.get(GRB_DoubleAttr_Runtime));
+    state.bound = max(state.bound, model.get(GRB_DoubleAttr_ObjBound));
+
+    // --- Solver results retrieval ---
+    if (verbose)
+        cout << "--> Retrieving solver results " << endl;
+
+    vector<int> succ;
+    int status = model.get(GRB_IntAttr_Status);
+    if (status == GRB_OPTIMAL || ((status == GRB_TIME_LIMIT || status == GRB_INTERRUPTED) && model.get(GRB_IntAttr_SolCount) > 0))
+    {
+        // the solver has computed the optimal solution or a feasible solution (when the time limit is reached or the run is stopped before proving optimality)
+        if (verbose)
         {
-            cout << "Error number: " << e.getErrorCode() << endl;
-            cout << e.getMessage() << endl;
+            cout << "Success! (Status: " << status << ")" << endl; //< prints the solver status (see the gurobi documentation)
+            cout << "--> Printing results " << endl;
         }
-        catch (...)
+
+        cout << label << ": ";
+        cout << config.instance << "; ";
+        cout << "runtime = " << model.get(GRB_DoubleAttr_Runtime) << " sec; ";
+        cout << "objective value = " << model.get(GRB_DoubleAttr_ObjVal) << "; "; //< gets the value of the objective function for the best computed solution (optimal if no time limit)
+        cout << "primal-dual integral = " << cb->trace.primalDualIntegral() << "; root bound = " << cb->trace.rootBound() << "; "; //< integral of the primal-dual gap over time (see trace.hpp)
+        cout << cb->stats.resultFields() << "; " << resourceFields(model) << extra; //< callback counters (see cutstats.hpp), model size and memory (see memory.hpp)
+        if (state.runtime > model.get(GRB_DoubleAttr_Runtime))
+            cout << "; total runtime = " << state.runtime << " sec"; //< with the runs it resumes
+        cout << endl;
+
+        // the edges of the undirected model are oriented along the tour starting from city 0
+        succ = subtourSolution(g, x, symmetric);
+        state.succ = succ;
+        state.objective = model.get(GRB_DoubleAttr_ObjVal);
+        if (verbose)
         {
-            cout << "Error during callback" << endl;
+            for (int i = 0, step = 0; step < n && succ[i] >= 0; ++step)
+            {
+                cout << "ville " << cb->city(i) << " --> "
+                     << "ville " << cb->city(succ[i]) << endl;
+                i = succ[i];
+                if (i == 0)
+                    break;
+            }
         }
+        // model.write("solution.sol"); //< Writes the solution in a file
     }
-};
+    else
+    {
+        // the model is infeasible (maybe wrong) or the solver has reached the time limit without finding a feasible solution
+        cerr << "Fail! (Status: " << status << ")" << endl; //< see status page in the Gurobi documentation
+    }
+    delete cb;
+    return succ;
+}
 
-int main(int argc,
-         char *argv[])
+// --merge=<K>: tour merging, the model restricted to the union of the arcs of
+// the K cheapest distinct tours of a multi-start run (see multistart.hpp)
+static int runMerge(const vector<vector<int>> &c, Config config)
 {
-    bool verbose = true;
-    if (argv[2] != NULL && strcmp(argv[2], "-nv") == 0)
+    bool verbose = config.verbose;
+    int n = c.size();
+    MultiStartOptions options;
+    options.threads = config.threads;
+    options.starts = (long)config.number("merge-starts", 0);
+    options.timeLimit = config.number("merge-time", 5.0);
+    options.seed = (unsigned)config.number("seed", 1);
+    options.candidates = (int)config.number("candidates", 3);
+    options.keep = max((int)config.number("merge", 10), 1);
+    MultiStartResult heuristic = multiStart(c, options);
+    int tours = heuristic.tours.size();
+
+    // arc frequencies: the arcs in every tour are likely in the optimal one
+    vector<int> frequency;
+    vector<pair<int, int>> arcs = tourUnion(heuristic.tours, frequency);
+    int common = count(frequency.begin(), frequency.end(), tours);
+    if (verbose)
+    {
+        cout << "--> Tour merging: " << tours << " tours of " << heuristic.starts << " starts (best " << heuristic.cost << "), "
+             << arcs.size() << " arcs in their union, " << common << " in every tour" << endl;
+        vector<int> histogram(tours + 1, 0);
+        for (int f : frequency)
+            histogram[f]++;
+        cout << "--> Arcs per number of tours using them:";
+        for (int k = 1; k <= tours; ++k)
+            cout << " " << k << ":" << histogram[k];
+        cout << endl;
+    }
+
+    bool symmetric = n > 2 && isSymmetric(c);
+    if (symmetric)
+    {
+        for (pair<int, int> &a : arcs)
+            a = make_pair(min(a.first, a.second), max(a.first, a.second));
+    }
+    Graph g = restrictGraph(c, arcs);
+    config.timeLimit = max(config.timeLimit - heuristic.seconds, 1.0);
+    fitMemoryBudget(config, g.m, 2LL * g.m); //< --memory-budget (see memory.hpp)
+
+    GRBVar *x = nullptr;
+    try
+    {
+        GRBEnv env = GRBEnv(true);
+        env.start();
+        GRBModel model = GRBModel(env);
+        if (!verbose)
+            model.set(GRB_IntParam_OutputFlag, 0);
+        x = buildSubtourModel(model, g, symmetric, verbose);
+        configure(model, config, "sousTours", n); //< time limit, threads and parameters (see config.hpp)
+        model.set(GRB_IntParam_LazyConstraints, 1);
+        setTourStart(x, g, heuristic.succ, symmetric);
+
+        Checkpoint state;
+        state.n = n;
+        state.instance = instanceHash(c);
+        stringstream extra;
+        extra << "; merged tours = " << tours << "; union arcs = " << g.m << "; common arcs = " << common
+              << "; best merged tour = " << heuristic.cost << "; heuristic time = " << heuristic.seconds << " sec";
+        solveModel(model, x, g, symmetric, config, "Result", extra.str(), state);
+    }
+    catch (GRBException e)
     {
-        verbose = false;
+        cout << "Error code = " << e.getErrorCode() << endl;
+        cout << e.getMessage() << endl;
     }
+    delete[] x;
+    return 0;
+}
+
+int main(int argc,
+         char *argv[])
+{
+    Config config = parseArgs(argc, argv, 600.0);
+    bool verbose = config.verbose;
 
     // parse and save the data
     vector<vector<int>> c = parse(argv[1]);
     int n = c.size();
+    if (config.has("lns"))
+        return runLns(c, config);
+    if (config.has("merge"))
+        return runMerge(c, config);
+
+    // --delta: cost changes applied to the model after the first solve (see reopt.hpp)
+    vector<Delta> deltas;
+    if (config.has("delta"))
+        deltas = readDeltas(config.get("delta"));
+    // --reopt: checkpoint of a previous run (see checkpoint.hpp), which replaces the first solve when there are deltas;
+    // --resume: the checkpoint of --checkpoint, if there is one already
+    Checkpoint state;
+    state.n = n;
+    state.instance = instanceHash(c); //< of the costs of the solve, changed by each delta
+    string resumePath = config.has("reopt") ? config.get("reopt") : config.has("resume") ? config.get("checkpoint") : "";
+    if (!resumePath.empty() && !readCheckpoint(resumePath, c, state))
+    {
+        if (config.has("reopt"))
+        {
+            cerr << "Checkpoint open failed: " << resumePath << endl;
+            exit(-1);
+        }
+        if (verbose)
+            cout << "--> No checkpoint to resume from: " << resumePath << endl;
+    }
 
-    GRBVar **x = nullptr;
-    GRBVar *u = nullptr;
+    // on symmetric instances x(i,j) and x(j,i) are the same edge: only x(i,j)
+    // with i < j is created, which halves the model (the deltas may break the symmetry)
+    bool symmetric = n > 2 && isSymmetric(c) && deltas.empty();
+
+    // only the arcs that can be in an optimal tour get a variable, for the
+    // instance and after each delta
+    vector<pair<int, int>> changed;
+    long long slack = deltaSlack(c, deltas, changed);
+    Graph g = buildGraph(c, slack >= 0, max(slack, 0LL), changed);
+    if (verbose)
+        printReport(g);
+    if (symmetric)
+    {
+        vector<pair<int, int>> edges;
+        for (int a = 0; a < g.m; ++a)
+            edges.push_back(make_pair(min(g.tail[a], g.head[a]), max(g.tail[a], g.head[a])));
+        g = restrictGraph(c, edges);
+    }
+    fitMemoryBudget(config, g.m, 2LL * g.m); //< --memory-budget (see memory.hpp)
+
+    GRBVar *x = nullptr;
     try
     {
         // --- Creation of the Gurobi environment ---
@@ -105,127 +311,100 @@ int main(int argc,
             model.set(GRB_IntParam_OutputFlag, 0);
         }
 
-        // --- Creation of the variables ---
-        if (verbose)
-            cout << "--> Creating the variables" << endl;
+        x = buildSubtourModel(model, g, symmetric, verbose);
 
-        x = new GRBVar *[n];
+        // Optimize model
+        // --- Solver configuration ---
+        if (verbose)
+            cout << "--> Configuring the solver" << endl;
+        configure(model, config, "sousTours", n); //< time limit, threads and parameters (see config.hpp)
+        model.set(GRB_IntParam_LazyConstraints, 1);  //< informs of the use of lazy constraints
 
-        for (size_t i = 0; i < n; ++i)
+        // --cut-library: the strongest subtour constraints of the previous runs of the instance (see cutlib.hpp)
+        string libraryPath = config.get("cut-library");
+        CutLibrary library;
+        vector<vector<int>> seeds;
+        if (!libraryPath.empty())
         {
-            x[i] = new GRBVar[n];
-            for (size_t j = 0; j < n; ++j)
-            {
-                stringstream ss;
-                ss << "x(" << i << "," << j << ")";
-                x[i][j] = model.addVar(0.0, 1.0, 0.0, GRB_BINARY, ss.str());
-            }
+            library = loadCutLibrary(libraryPath, c);
+            seeds = seedCuts(library, (int)config.number("cut-library-seeds", 200));
+            addSubtourConstraints(model, x, g, seeds, 0);
+            if (verbose)
+                cout << "--> Cut library " << library.path << ": " << seeds.size() << " of " << library.cuts.size() << " cuts seeded" << endl;
         }
+        size_t resumed = state.subtours.size();
 
-        // --- Creation of the objective function ---
-        if (verbose)
-            cout << "--> Creating the objective function" << endl;
-        GRBLinExpr obj = 0;
-        for (size_t i = 0; i < n; ++i)
+        // --short-cycles: the constraints of the 2-cycles and of the cheapest 3-cycles
+        // from the start, rather than one lazy constraint per incumbent
+        string shortExtra;
+        if (config.has("short-cycles"))
         {
-            for (size_t j = 0; j < n; ++j)
+            vector<vector<int>> sets = shortCycles(c, g, symmetric, (int)config.number("triangles", n), (int)config.number("triangle-neighbours", 8));
+            int pairs = 0;
+            for (size_t k = 0; k < sets.size(); ++k)
             {
-                obj += c[i][j] * x[i][j];
-            }
-        }
-        model.setObjective(obj, GRB_MINIMIZE);
-
-        // --- Creation of the constraints ---
-        if (verbose)
-            cout << "--> Creating the constraints" << endl;
-
-        // Respect flot 1
-        for (size_t j = 0; j < n; ++j)
-        {
-            GRBLinExpr flot1 = 0;
-            for (size_t i = 0; i < n; ++i)
-            {
-                flot1 += x[i][j];
+                pairs += sets[k].size() == 2;
+                stringstream ss;
+                ss << "ShortCycle(" << k << ")";
+                model.addConstr(insideArcs(g, x, sets[k]) <= (int)sets[k].size() - 1, ss.str());
             }
-            stringstream ss;
-            ss << "Flot1(" << j << ")";
-            model.addConstr(flot1 == 1, ss.str());
+            shortExtra = "; 2-cycles = " + to_string((long long)pairs) + "; 3-cycles = " + to_string((long long)(sets.size() - pairs));
+            if (verbose)
+                cout << "--> Short cycles: " << pairs << " 2-cycle and " << sets.size() - pairs << " 3-cycle constraints" << endl;
         }
 
-        // Respect flot 2
-        for (size_t i = 0; i < n; ++i)
+        // the subtour constraints found so far are in the model for every later solve
+        addSubtourConstraints(model, x, g, state.subtours, 0);
+        size_t added = state.subtours.size();
+        vector<int> succ = state.succ;
+        if (!succ.empty())
+            setTourStart(x, g, succ, symmetric);
+        if (verbose && !resumePath.empty())
+            cout << "--> Resuming: " << added << " subtour constraints, bound " << state.bound << ", " << state.runtime << " sec" << endl;
+        if (state.succ.empty() || deltas.empty())
         {
-            GRBLinExpr flot2 = 0;
-            for (size_t j = 0; j < n; ++j)
-            {
-                flot2 += x[i][j];
-            }
-            stringstream ss;
-            ss << "Flot2(" << i << ")";
-            model.addConstr(flot2 == 1, ss.str());
+            // the bound of the previous runs holds for the same costs only
+            if (deltas.empty() && isfinite(state.bound))
+                addBoundConstraint(model, x, g, state.bound);
+            string extra = shortExtra;
+            if (!libraryPath.empty())
+                extra += "; library cuts = " + to_string((long long)seeds.size());
+            succ = solveModel(model, x, g, symmetric, config, "Result", extra, state);
         }
 
-        // Callback
-        Callback *cb = new Callback(x, n); // passing variable x to the solver callback
-        model.setCallback(cb);             // adding the callback to the model
-
-        // Optimize model
-        // --- Solver configuration ---
-        if (verbose)
-            cout << "--> Configuring the solver" << endl;
-        model.set(GRB_DoubleParam_TimeLimit, 600.0); //< sets the time limit (in seconds)
-        model.set(GRB_IntParam_Threads, 1);          //< limits the solver to single thread usage
-        model.set(GRB_IntParam_LazyConstraints, 1);  //< informs of the use of lazy constraints
-
-        // --- Solver launch ---
-        if (verbose)
-            cout << "--> Running the solver" << endl;
-        model.optimize();
-        // model.write("model.lp"); //< Writes the model in a file
-
-        // --- Solver results retrieval ---
-        if (verbose)
-            cout << "--> Retrieving solver results " << endl;
-
-        int status = model.get(GRB_IntAttr_Status);
-        if (status == GRB_OPTIMAL || (status == GRB_TIME_LIMIT && model.get(GRB_IntAttr_SolCount) > 0))
+        for (size_t d = 0; d < deltas.size(); ++d)
         {
-            // the solver has computed the optimal solution or a feasible solution (when the time limit is reached before proving optimality)
+            applyDelta(c, deltas[d]);
+            int modified = updateCosts(x, g, c, deltas[d]);
+            addSubtourConstraints(model, x, g, state.subtours, added);
+            added = state.subtours.size();
+            bool started = !succ.empty() && setTourStart(x, g, succ, symmetric);
             if (verbose)
-            {
-                cout << "Success! (Status: " << status << ")" << endl; //< prints the solver status (see the gurobi documentation)
-                cout << "--> Printing results " << endl;
-            }
+                cout << "--> Delta " << d + 1 << ": " << modified << " coefficients modified, " << added << " subtour constraints kept" << endl;
+            // the tour and bound of the checkpoints of this solve are for the new costs,
+            // which a later run must be given to resume from them
+            state.instance = instanceHash(c);
+            state.bound = -GRB_INFINITY;
+            state.objective = started ? successorCost(c, succ) : GRB_INFINITY;
+            if (!started)
+                state.succ.clear();
 
-            cout << "Result: ";
-            cout << argv[1] << "; ";
-            cout << "runtime = " << model.get(GRB_DoubleAttr_Runtime) << " sec; ";
-            cout << "objective value = " << model.get(GRB_DoubleAttr_ObjVal) << endl; //< gets the value of the objective function for the best computed solution (optimal if no time limit)
-
-            if (verbose)
-            {
-                int i = 0;
-                for (size_t j = 0; j < n; ++j)
-                {
-                    if (x[i][j].get(GRB_DoubleAttr_X) >= 0.5)
-                    {
-                        cout << "ville " << i << " --> "
-                             << "ville " << j << endl;
-                        i = j;
-                        if (i == 0)
-                            break;
-                        j = -1;
-                    }
-                }
-            }
-            // model.write("solution.sol"); //< Writes the solution in a file
+            stringstream extra;
+            extra << "; delta = " << d + 1 << "; changed arcs = " << deltas[d].size() << "; kept cuts = " << added << "; warm start = " << started;
+            succ = solveModel(model, x, g, symmetric, config, "Reopt", extra.str(), state);
         }
-        else
+
+        if (!libraryPath.empty())
         {
-            // the model is infeasible (maybe wrong) or the solver has reached the time limit without finding a feasible solution
-            cerr << "Fail! (Status: " << status << ")" << endl; //< see status page in the Gurobi documentation
+            vector<vector<int>> found(state.subtours.begin() + resumed, state.subtours.end());
+            recordRun(library, found, seeds, succ, (size_t)config.number("cut-library-size", 5000));
+            if (!saveCutLibrary(library))
+                cerr << "Cut library write failed: " << library.path << endl;
         }
-        delete cb;
+
+        string statePath = config.get("save-state");
+        if (!statePath.empty() && (state.succ.empty() || !writeCheckpoint(statePath, state)))
+            cerr << "State write failed: " << statePath << endl;
     }
     catch (GRBException e)
     {
@@ -237,14 +416,7 @@ int main(int argc,
         cout << "Exception during optimization" << endl;
     }
 
-    delete[] u;
-
-    for (size_t j = 0; j < n; ++j)
-    {
-        delete[] x[j];
-    }
-
     delete[] x;
 
     return 0;
-}
\ No newline at end of file
+}
@@ -1,67 +1,80 @@
 #include "gurobi_c++.h"
+#include "graph.hpp"
 #include "parser.hpp"
+#include "memory.hpp"
+#include "solver.hpp"
+#include "callback.hpp"
+#include "cutlib.hpp"
+#include "reopt.hpp"
+#include "separation.hpp"
+#include "subtour.hpp"
 #include <stack>
 #include <cstring>
 using namespace std;
 
-class Callback : public GRBCallback
+class Callback : public ModelCallback
 {
 public:
-    GRBVar **_x;
+    GRBVar *_x;
+    const Graph *g;
     int n;
+    string capture;  ///< file receiving the first node relaxation (bench fixture), empty if none
+    int dkLength;    ///< longest lifted cycle searched (D_k+ / D_k- inequalities), 0 if off
+    double dkBudget; ///< time of the lifted cycle search at each node, in seconds
+    int dkCuts;      ///< most violated lifted cycle inequalities added at each node
+    vector<vector<int>> subtours; ///< sets S of the subtour cuts added, for the cut library
 
     /**
        The constructor is used to get a pointer to the variables that are needed.
      */
-    Callback(GRBVar **x, int nb)
+    Callback(GRBVar *x, const Graph *graph, const Config &config)
     {
-        cout << "here" << endl;
         _x = x;
-        n = nb;
+        g = graph;
+        n = graph->n;
+        capture = config.get("capture");
+        dkLength = config.has("dk") ? (int)config.number("dk-length", 6) : 0;
+        dkBudget = config.number("dk-budget", 0.005);
+        dkCuts = (int)config.number("dk-cuts", 20);
     }
 
 protected:
-    void callback()
+    void separate()
     {
         try
         {
             if (where == GRB_CB_MIPNODE && getIntInfo(GRB_CB_MIPNODE_STATUS) == GRB_OPTIMAL)
             {
-                vector<int> indices;
-                GRBLinExpr tour = 0;
-                int taille = 0;
-                int i = 0;
-                for (int j = 0; j < n; ++j)
+                vector<double> xVal(n * n, 0.0);
+                double *val = getNodeRel(_x, g->m);
+                for (int a = 0; a < g->m; ++a)
+                    xVal[g->tail[a] * n + g->head[a]] = val[a];
+                delete[] val;
+                if (!capture.empty())
                 {
-                    double xVal = getNodeRel(_x[i][j]);
-
-                    cout << "x(" << i << "," << j << ") = " << xVal << endl;
-                    if (xVal > 0)
-                    {
-                        cout << "x(" << i << "," << j << ")" << xVal << endl;
-                        indices.push_back(i);
-                        // tour += x[i][j];
-                        taille += 1;
-                        i = j;
-                        if (i == 0)
-                            break;
-                        j = -1;
-                    }
+                    writeRelaxation(capture, xVal, n, 2);
+                    capture.clear();
                 }
-                // cout << endl  << "#######" << taille << "#######" << endl;
-                if (taille < n)
+                vector<int> indices = subtourFromRelaxation(xVal.data(), n);
+                if (!indices.empty())
                 { // sous-tour existe
-                    // cout << tour << endl;
-                    cout << "Constraint not satisfied : sous tour de taille " << taille << " existe. Adding this constraint." << endl;
+                    vector<char> inS(n, 0);
+                    for (int k : indices)
+                        inS[k] = 1;
+                    GRBLinExpr tour = 0;
                     for (int k : indices)
                     {
-                        for (int l : indices)
+                        for (int a = g->outStart[k]; a < g->outStart[k + 1]; ++a)
                         {
-                            tour += _x[k][l];
+                            if (inS[g->head[a]])
+                                tour += _x[a];
                         }
                     }
-                    addCut(tour <= taille - 1);
+                    addCut(tour <= (int)indices.size() - 1, subtourLhs(xVal.data(), n, indices) - (indices.size() - 1), indices);
+                    subtours.push_back(indices);
                 }
+                if (dkLength >= 3)
+                    addLiftedCycleCuts(xVal);
             }
         }
         catch (GRBException e)
@@ -74,23 +87,49 @@ protected:
             cout << "Error during callback" << endl;
         }
     }
+
+    // D_k+ and D_k- inequalities of the cycles of the support graph (see separation.hpp)
+    void addLiftedCycleCuts(const vector<double> &xVal)
+    {
+        vector<pair<int, int>> arcs;
+        vector<int> coefficients;
+        for (const LiftedCycleCut &cut : liftedCycleViolations(xVal.data(), n, dkLength, dkBudget, dkCuts))
+        {
+            int k = cut.sequence.size();
+            liftedCycleCoefficients(cut.sequence, cut.plus, arcs, coefficients);
+            GRBLinExpr lifted = 0;
+            for (size_t a = 0; a < arcs.size(); ++a)
+            {
+                int arc = g->arc(arcs[a].first, arcs[a].second);
+                if (arc >= 0) // arcs out of the graph are at 0
+                    lifted += coefficients[a] * _x[arc];
+            }
+            // the support tells the position of each city and the family apart
+            vector<int> support;
+            for (int h = 0; h < k; ++h)
+                support.push_back(((cut.plus ? 0 : k) + h) * n + cut.sequence[h]);
+            addCut(lifted <= k - 1, cut.violation, support);
+        }
+    }
 };
 
 int main(int argc,
          char *argv[])
 {
-    bool verbose = true;
-    if (argv[2] != NULL && strcmp(argv[2], "-nv") == 0)
-    {
-        verbose = false;
-    }
+    Config config = parseArgs(argc, argv, 600.0);
+    bool verbose = config.verbose;
 
     // parse and save the data
     vector<vector<int>> c = parse(argv[1]);
     int n = c.size();
 
-    GRBVar **x = nullptr;
-    GRBVar *u = nullptr;
+    // only the arcs that can be in an optimal tour get a variable
+    Graph g = buildGraph(c);
+    if (verbose)
+        printReport(g);
+    fitMemoryBudget(config, g.m, 2LL * g.m); //< --memory-budget (see memory.hpp)
+
+    GRBVar *x = nullptr;
     try
     {
         // --- Creation of the Gurobi environment ---
@@ -116,29 +155,22 @@ int main(int argc,
         if (verbose)
             cout << "--> Creating the variables" << endl;
 
-        x = new GRBVar *[n];
+        x = trackedArray<GRBVar>(g.m);
 
-        for (size_t i = 0; i < n; ++i)
+        for (int a = 0; a < g.m; ++a)
         {
-            x[i] = new GRBVar[n];
-            for (size_t j = 0; j < n; ++j)
-            {
-                stringstream ss;
-                ss << "x(" << i << "," << j << ")";
-                x[i][j] = model.addVar(0.0, 1.0, 0.0, GRB_BINARY, ss.str());
-            }
+            stringstream ss;
+            ss << "x(" << g.tail[a] << "," << g.head[a] << ")";
+            x[a] = model.addVar(0.0, 1.0, 0.0, GRB_BINARY, ss.str());
         }
 
         // --- Creation of the objective function ---
         if (verbose)
             cout << "--> Creating the objective function" << endl;
         GRBLinExpr obj = 0;
-        for (size_t i = 0; i < n; ++i)
+        for (int a = 0; a < g.m; ++a)
         {
-            for (size_t j = 0; j < n; ++j)
-            {
-                obj += c[i][j] * x[i][j];
-            }
+            obj += g.cost[a] * x[a];
         }
         model.setObjective(obj, GRB_MINIMIZE);
 
@@ -147,12 +179,12 @@ int main(int argc,
             cout << "--> Creating the constraints" << endl;
 
         // Respect flot 1
-        for (size_t j = 0; j < n; ++j)
+        for (int j = 0; j < n; ++j)
         {
             GRBLinExpr flot1 = 0;
-            for (size_t i = 0; i < n; ++i)
+            for (int p = g.inStart[j]; p < g.inStart[j + 1]; ++p)
             {
-                flot1 += x[i][j];
+                flot1 += x[g.inArc[p]];
             }
             stringstream ss;
             ss << "Flot1(" << j << ")";
@@ -160,37 +192,47 @@ int main(int argc,
         }
 
         // Respect flot 2
-        for (size_t i = 0; i < n; ++i)
+        for (int i = 0; i < n; ++i)
         {
             GRBLinExpr flot2 = 0;
-            for (size_t j = 0; j < n; ++j)
+            for (int a = g.outStart[i]; a < g.outStart[i + 1]; ++a)
             {
-                flot2 += x[i][j];
+                flot2 += x[a];
             }
             stringstream ss;
             ss << "Flot2(" << i << ")";
             model.addConstr(flot2 == 1, ss.str());
         }
 
-        // Callback
-        Callback *cb = new Callback(x, n); // passing variable x to the solver callback
-        model.setCallback(cb);             // adding the callback to the model
-
         // Optimize model
         // --- Solver configuration ---
         if (verbose)
             cout << "--> Configuring the solver" << endl;
-        model.set(GRB_DoubleParam_TimeLimit, 600.0); //< sets the time limit (in seconds)
-        model.set(GRB_IntParam_Threads, 1);          //< limits the solver to single thread usage
+        configure(model, config, "sousTours_cut", n); //< time limit, threads and parameters (see config.hpp)
+
+        // --cut-library: the strongest subtour constraints of the previous runs of the instance (see cutlib.hpp)
+        string libraryPath = config.get("cut-library");
+        CutLibrary library;
+        vector<vector<int>> seeds;
+        if (!libraryPath.empty())
+        {
+            library = loadCutLibrary(libraryPath, c);
+            seeds = seedCuts(library, (int)config.number("cut-library-seeds", 200));
+            addSubtourConstraints(model, x, g, seeds, 0);
+            if (verbose)
+                cout << "--> Cut library " << library.path << ": " << seeds.size() << " of " << library.cuts.size() << " cuts seeded" << endl;
+        }
 
         // Callback
-        Callback *cb = new Callback(x, n); // passing variable x to the solver callback
-        model.setCallback(cb);             // adding the callback to the model
+        Callback *cb = new Callback(x, &g, config); // passing variable x to the solver callback
+        model.setCallback(cb);                      // adding the callback to the model
+        cb->watch(config, ArcVariables(&g, x), instanceHash(c)); //< --incumbents, --stop-file and --checkpoint
 
         //  --- Solver launch ---
         if (verbose)
             cout << "--> Running the solver" << endl;
         model.optimize();
+        finishCallback(model, *cb, config);
         // model.write("model.lp"); //< Writes the model in a file
 
         // --- Solver results retrieval ---
@@ -198,9 +240,9 @@ int main(int argc,
             cout << "--> Retrieving solver results " << endl;
 
         int status = model.get(GRB_IntAttr_Status);
-        if (status == GRB_OPTIMAL || (status == GRB_TIME_LIMIT && model.get(GRB_IntAttr_SolCount) > 0))
+        if (status == GRB_OPTIMAL || ((status == GRB_TIME_LIMIT || status == GRB_INTERRUPTED) && model.get(GRB_IntAttr_SolCount) > 0))
         {
-            // the solver has computed the optimal solution or a feasible solution (when the time limit is reached before proving optimality)
+            // the solver has computed the optimal solution or a feasible solution (when the time limit is reached or the run is stopped before proving optimality)
             if (verbose)
             {
                 cout << "Success! (Status: " << status << ")" << endl; //< prints the solver status (see the gurobi documentation)
@@ -210,37 +252,41 @@ int main(int argc,
             cout << "Result: ";
             cout << argv[1] << "; ";
             cout << "runtime = " << model.get(GRB_DoubleAttr_Runtime) << " sec; ";
-            cout << "objective value = " << model.get(GRB_DoubleAttr_ObjVal) << endl; //< gets the value of the objective function for the best computed solution (optimal if no time limit)
+            cout << "objective value = " << model.get(GRB_DoubleAttr_ObjVal) << "; "; //< gets the value of the objective function for the best computed solution (optimal if no time limit)
+            cout << "primal-dual integral = " << cb->trace.primalDualIntegral() << "; root bound = " << cb->trace.rootBound() << "; "; //< integral of the primal-dual gap over time (see trace.hpp)
+            cout << cb->stats.resultFields() << "; " << resourceFields(model); //< callback counters (see cutstats.hpp), model size and memory (see memory.hpp)
+            if (!libraryPath.empty())
+                cout << "; library cuts = " << seeds.size();
+            cout << endl;
 
             if (verbose)
             {
+                vector<int> succ(n, -1);
+                for (int a = 0; a < g.m; ++a)
+                {
+                    if (x[a].get(GRB_DoubleAttr_X) >= 0.5)
+                        succ[g.tail[a]] = g.head[a];
+                }
                 int i = 0;
-                for (size_t j = 0; j < n; ++j)
+                for (int step = 0; step < n && succ[i] >= 0; ++step)
                 {
-                    if ((int)x[i][j].get(GRB_DoubleAttr_X) == 1)
-                    {
-                        cout << "ville " << i << " --> "
-                             << "ville " << j << endl;
-                        i = j;
-                        if (i == 0)
-                            break;
-                        j = -1;
-                    }
+                    cout << "ville " << cb->city(i) << " --> "
+                         << "ville " << cb->city(succ[i]) << endl;
+                    i = succ[i];
+                    if (i == 0)
+                        break;
                 }
 
                 cout << endl
                      << "representation brute:" << endl
                      << endl;
 
-                for (size_t i = 0; i < n; ++i)
+                for (int a = 0; a < g.m; ++a)
                 {
-                    for (size_t j = 0; j < n; ++j)
+                    if (x[a].get(GRB_DoubleAttr_X) >= 0.5)
                     {
-                        if (x[i][j].get(GRB_DoubleAttr_X) == 1.0)
-                        {
-                            cout << "ville " << i << " --> "
-                                 << "ville " << j << endl;
-                        }
+                        cout << "ville " << cb->city(g.tail[a]) << " --> "
+                             << "ville " << cb->city(g.head[a]) << endl;
                     }
                 }
             }
@@ -251,6 +297,15 @@ int main(int argc,
             // the model is infeasible (maybe wrong) or the solver has reached the time limit without finding a feasible solution
             cerr << "Fail! (Status: " << status << ")" << endl; //< see status page in the Gurobi documentation
         }
+        if (!libraryPath.empty())
+        {
+            vector<int> succ;
+            if (model.get(GRB_IntAttr_SolCount) > 0)
+                succ = subtourSolution(g, x, false);
+            recordRun(library, cb->subtours, seeds, succ, (size_t)config.number("cut-library-size", 5000));
+            if (!saveCutLibrary(library))
+                cerr << "Cut library write failed: " << library.path << endl;
+        }
         delete cb;
     }
     catch (GRBException e)
@@ -263,13 +318,6 @@ int main(int argc,
         cout << "Exception during optimization" << endl;
     }
 
-    delete[] u;
-
-    for (size_t j = 0; j < n; ++j)
-    {
-        delete[] x[j];
-    }
-
     delete[] x;
 
     return 0;
@@ -0,0 +1,272 @@
+#include <iostream>
+#include <sstream>
+#include "subtour.hpp"
+#include "parser.hpp"
+#include "memory.hpp"
+#include "separation.hpp"
+#include "tour.hpp"
+
+SubtourCallback::SubtourCallback(GRBVar *_x, const Graph *_g, const std::atomic<bool> *_cancel)
+{
+    x = _x;
+    g = _g;
+    n = _g->n;
+    cancel = _cancel;
+}
+
+void SubtourCallback::separate()
+{
+    try
+    {
+        if (cancel != nullptr && cancel->load())
+        {
+            abort();
+            return;
+        }
+        if (where == GRB_CB_MIPSOL)
+        {
+            std::vector<double> xVal(n * n, 0.0);
+            double *val = getSolution(x, g->m);
+            for (int a = 0; a < g->m; ++a)
+                xVal[g->tail[a] * n + g->head[a]] = val[a];
+            delete[] val;
+            std::vector<int> indices = subtourFromSolution(xVal.data(), n);
+            if (!indices.empty())
+            { // sous-tour existe
+                addLazy(insideArcs(*g, x, indices) <= (int)indices.size() - 1, subtourLhs(xVal.data(), n, indices) - (indices.size() - 1), indices);
+                cuts.push_back(indices);
+            }
+        }
+    }
+    catch (GRBException e)
+    {
+        // on stderr: stdout carries the responses of the service
+        std::cerr << "Error number: " << e.getErrorCode() << std::endl;
+        std::cerr << e.getMessage() << std::endl;
+    }
+    catch (...)
+    {
+        std::cerr << "Error during callback" << std::endl;
+    }
+}
+
+void SubtourCallback::saveCuts(Checkpoint &checkpoint) const
+{
+    checkpoint.subtours.insert(checkpoint.subtours.end(), cuts.begin(), cuts.end());
+}
+
+UndirectedSubtourCallback::UndirectedSubtourCallback(GRBVar *_x, const Graph *_g)
+{
+    x = _x;
+    g = _g;
+    n = _g->n;
+}
+
+void UndirectedSubtourCallback::separate()
+{
+    try
+    {
+        if (where == GRB_CB_MIPSOL)
+        {
+            std::vector<double> xVal(n * n, 0.0);
+            double *val = getSolution(x, g->m);
+            for (int a = 0; a < g->m; ++a)
+                xVal[g->tail[a] * n + g->head[a]] = val[a];
+            delete[] val;
+            std::vector<std::vector<int>> components = edgeComponents(xVal.data(), n);
+            if (components.size() > 1)
+            { // sous-tours existent
+                std::vector<int> component(n);
+                for (size_t s = 0; s < components.size(); ++s)
+                    for (int k : components[s])
+                        component[k] = s;
+                for (const std::vector<int> &S : components)
+                {
+                    GRBLinExpr tour = 0;
+                    for (int k : S)
+                    {
+                        for (int a = g->outStart[k]; a < g->outStart[k + 1]; ++a)
+                        {
+                            if (component[g->head[a]] == component[k])
+                                tour += x[a];
+                        }
+                    }
+                    addLazy(tour <= (int)S.size() - 1, subtourLhs(xVal.data(), n, S) - (S.size() - 1), S);
+                    cuts.push_back(S);
+                }
+            }
+        }
+    }
+    catch (GRBException e)
+    {
+        // on stderr: stdout carries the responses of the service
+        std::cerr << "Error number: " << e.getErrorCode() << std::endl;
+        std::cerr << e.getMessage() << std::endl;
+    }
+    catch (...)
+    {
+        std::cerr << "Error during callback" << std::endl;
+    }
+}
+
+void UndirectedSubtourCallback::saveCuts(Checkpoint &checkpoint) const
+{
+    checkpoint.subtours.insert(checkpoint.subtours.end(), cuts.begin(), cuts.end());
+}
+
+GRBLinExpr insideArcs(const Graph &g, const GRBVar *x, const std::vector<int> &S)
+{
+    std::vector<char> inS(g.n, 0);
+    for (int k : S)
+        inS[k] = 1;
+    GRBLinExpr inside = 0;
+    for (int k : S)
+    {
+        for (int a = g.outStart[k]; a < g.outStart[k + 1]; ++a)
+        {
+            if (inS[g.head[a]])
+                inside += x[a];
+        }
+    }
+    return inside;
+}
+
+GRBVar *buildSubtourModel(GRBModel &model, const Graph &g, bool symmetric, bool verbose)
+{
+    int n = g.n;
+
+    // --- Creation of the variables ---
+    if (verbose)
+        std::cout << "--> Creating the variables" << std::endl;
+
+    if (verbose && symmetric)
+        std::cout << "--> Symmetric instance: undirected formulation" << std::endl;
+
+    GRBVar *x = trackedArray<GRBVar>(g.m);
+
+    for (int a = 0; a < g.m; ++a)
+    {
+        std::stringstream ss;
+        ss << "x(" << g.tail[a] << "," << g.head[a] << ")";
+        // forbidden arcs are only in the graph for a later re-optimisation: closed by their bound
+        x[a] = model.addVar(0.0, g.cost[a] >= forbiddenCost ? 0.0 : 1.0, 0.0, GRB_BINARY, ss.str());
+    }
+
+    // --- Creation of the objective function ---
+    if (verbose)
+        std::cout << "--> Creating the objective function" << std::endl;
+    GRBLinExpr obj = 0;
+    for (int a = 0; a < g.m; ++a)
+    {
+        if (g.cost[a] < forbiddenCost)
+            obj += g.cost[a] * x[a];
+    }
+    model.setObjective(obj, GRB_MINIMIZE);
+
+    // --- Creation of the constraints ---
+    if (verbose)
+        std::cout << "--> Creating the constraints" << std::endl;
+
+    // Degre 2 (undirected formulation)
+    for (int i = 0; symmetric && i < n; ++i)
+    {
+        GRBLinExpr degre = 0;
+        for (int a = g.outStart[i]; a < g.outStart[i + 1]; ++a)
+        {
+            degre += x[a];
+        }
+        for (int p = g.inStart[i]; p < g.inStart[i + 1]; ++p)
+        {
+            degre += x[g.inArc[p]];
+        }
+        std::stringstream ss;
+        ss << "Degre(" << i << ")";
+        model.addConstr(degre == 2, ss.str());
+    }
+
+    // Respect flot 1
+    for (int j = 0; !symmetric && j < n; ++j)
+    {
+        GRBLinExpr flot1 = 0;
+        for (int p = g.inStart[j]; p < g.inStart[j + 1]; ++p)
+        {
+            flot1 += x[g.inArc[p]];
+        }
+        std::stringstream ss;
+        ss << "Flot1(" << j << ")";
+        model.addConstr(flot1 == 1, ss.str());
+    }
+
+    // Respect flot 2
+    for (int i = 0; !symmetric && i < n; ++i)
+    {
+        GRBLinExpr flot2 = 0;
+        for (int a = g.outStart[i]; a < g.outStart[i + 1]; ++a)
+        {
+            flot2 += x[a];
+        }
+        std::stringstream ss;
+        ss << "Flot2(" << i << ")";
+        model.addConstr(flot2 == 1, ss.str());
+    }
+    return x;
+}
+
+std::vector<int> subtourSolution(const Graph &g, const GRBVar *x, bool symmetric)
+{
+    std::vector<double> value(g.m);
+    for (int a = 0; a < g.m; ++a)
+        value[a] = x[a].get(GRB_DoubleAttr_X);
+    return arcSuccessors(g, value, symmetric);
+}
+
+bool solveSubtour(GRBEnv &env, const std::vector<std::vector<int>> &c, double timeLimit, std::vector<int> &succ, bool &optimal,
+                  const std::atomic<bool> *cancel)
+{
+    long long cost = successorCost(c, succ);
+    Graph g = buildGraph(c);
+    optimal = false;
+
+    GRBVar *x = nullptr;
+    bool improved = false;
+    try
+    {
+        GRBModel model = GRBModel(env);
+        model.set(GRB_IntParam_OutputFlag, 0);
+        x = buildSubtourModel(model, g, false);
+
+        // the current tour as MIP start, when the reduction kept all its arcs
+        for (int i = 0; i < g.n; ++i)
+        {
+            int a = g.arc(i, succ[i]);
+            if (a >= 0)
+                x[a].set(GRB_DoubleAttr_Start, 1.0);
+        }
+        SubtourCallback cb(x, &g, cancel);
+        model.setCallback(&cb);
+        model.set(GRB_IntParam_LazyConstraints, 1);
+        model.set(GRB_IntParam_Threads, 1);
+        model.set(GRB_DoubleParam_TimeLimit, timeLimit);
+        model.set(GRB_DoubleParam_Cutoff, cost - 0.5); //< integer costs: only strictly better tours
+        model.optimize();
+
+        int status = model.get(GRB_IntAttr_Status);
+        optimal = status == GRB_OPTIMAL || status == GRB_CUTOFF || status == GRB_INFEASIBLE;
+        if (model.get(GRB_IntAttr_SolCount) > 0 && model.get(GRB_DoubleAttr_ObjVal) < cost - 0.5)
+        {
+            std::vector<int> repaired = subtourSolution(g, x, false);
+            if (cycleFrom(repaired, 0).size() == repaired.size())
+            {
+                succ = repaired;
+                improved = true;
+            }
+        }
+    }
+    catch (...)
+    {
+        delete[] x;
+        throw;
+    }
+    delete[] x;
+    return improved;
+}
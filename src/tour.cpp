@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cstddef>
+#include "tour.hpp"
+
+long long tourCost(const std::vector<std::vector<int>> &c, const std::vector<int> &tour)
+{
+    long long cost = 0;
+    int n = tour.size();
+    for (int k = 0; k < n; ++k)
+    {
+        cost += c[tour[k]][tour[(k + 1) % n]];
+    }
+    return cost;
+}
+
+long long successorCost(const std::vector<std::vector<int>> &c, const std::vector<int> &succ)
+{
+    long long cost = 0;
+    for (size_t i = 0; i < succ.size(); ++i)
+    {
+        cost += c[i][succ[i]];
+    }
+    return cost;
+}
+
+std::vector<int> tourToSuccessors(const std::vector<int> &tour)
+{
+    int n = tour.size();
+    std::vector<int> succ(n);
+    for (int k = 0; k < n; ++k)
+    {
+        succ[tour[k]] = tour[(k + 1) % n];
+    }
+    return succ;
+}
+
+std::vector<int> successorsToTour(const std::vector<int> &succ, int start)
+{
+    return cycleFrom(succ, start);
+}
+
+// follows the successors from a city until it comes back to an already visited
+// city, so a broken successor array (-1 or a rho-shaped path) cannot loop forever
+std::vector<int> cycleFrom(const std::vector<int> &succ, int start)
+{
+    int n = succ.size();
+    std::vector<char> seen(n, 0);
+    std::vector<int> cycle;
+    int i = start;
+    while (i >= 0 && i < n && !seen[i])
+    {
+        seen[i] = 1;
+        cycle.push_back(i);
+        i = succ[i];
+    }
+    return cycle;
+}
+
+std::vector<std::vector<int>> cycles(const std::vector<int> &succ)
+{
+    int n = succ.size();
+    std::vector<char> seen(n, 0);
+    std::vector<std::vector<int>> result;
+    for (int start = 0; start < n; ++start)
+    {
+        if (seen[start])
+            continue;
+        std::vector<int> cycle;
+        int i = start;
+        while (i >= 0 && i < n && !seen[i])
+        {
+            seen[i] = 1;
+            cycle.push_back(i);
+            i = succ[i];
+        }
+        result.push_back(cycle);
+    }
+    return result;
+}
+
+std::vector<std::pair<int, int>> tourUnion(const std::vector<std::vector<int>> &tours, std::vector<int> &frequency)
+{
+    std::vector<std::pair<int, int>> all;
+    for (const std::vector<int> &succ : tours)
+    {
+        for (int i = 0; i < (int)succ.size(); ++i)
+            all.push_back(std::make_pair(i, succ[i]));
+    }
+    std::sort(all.begin(), all.end());
+    std::vector<std::pair<int, int>> arcs;
+    frequency.clear();
+    for (size_t k = 0; k < all.size(); ++k)
+    {
+        if (k > 0 && all[k] == all[k - 1])
+            frequency.back()++;
+        else
+        {
+            arcs.push_back(all[k]);
+            frequency.push_back(1);
+        }
+    }
+    return arcs;
+}
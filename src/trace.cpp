@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include "trace.hpp"
+
+// Gurobi reports a missing incumbent or bound as +/-1e100
+static bool missing(double value)
+{
+    return !(fabs(value) < 1e99);
+}
+
+double primalDualGap(double incumbent, double bound)
+{
+    if (missing(incumbent) || missing(bound))
+        return 1.0;
+    if (fabs(incumbent - bound) <= 1e-9 * std::max(1.0, fabs(incumbent)))
+        return 0.0;
+    if (incumbent * bound < 0)
+        return 1.0;
+    return std::min(1.0, fabs(incumbent - bound) / std::max(fabs(incumbent), fabs(bound)));
+}
+
+static bool changed(double a, double b)
+{
+    if (missing(a) || missing(b))
+        return missing(a) != missing(b);
+    return fabs(a - b) > 1e-9 * std::max(1.0, fabs(a));
+}
+
+Trace::Trace(size_t capacity)
+    : buffer(std::max(capacity, (size_t)1)), next(0), count(0), integral(0), root(-1e100), started(false)
+{
+}
+
+void Trace::store(const TracePoint &point)
+{
+    buffer[next] = point;
+    next = (next + 1) % buffer.size();
+    count++;
+}
+
+void Trace::record(double time, double incumbent, double bound, double nodes)
+{
+    TracePoint point = {time, incumbent, bound, nodes};
+    if (nodes == 0 && !missing(bound))
+        root = std::max(root, bound);
+    if (!started)
+    {
+        // the gap is 1 from the start of the run to the first sample
+        integral = time;
+        started = true;
+        last = point;
+        store(point);
+        return;
+    }
+    if (time > last.time)
+        integral += (time - last.time) * primalDualGap(last.incumbent, last.bound);
+    bool progress = changed(incumbent, last.incumbent) || changed(bound, last.bound);
+    last = point;
+    if (progress)
+        store(point);
+}
+
+void Trace::finish(double time, double incumbent, double bound, double nodes)
+{
+    record(time, incumbent, bound, nodes);
+    if (count == 0 || buffer[(next + buffer.size() - 1) % buffer.size()].time != time)
+        store(last);
+}
+
+double Trace::primalDualIntegral() const
+{
+    return integral;
+}
+
+double Trace::rootBound() const
+{
+    return root;
+}
+
+std::vector<TracePoint> Trace::points() const
+{
+    std::vector<TracePoint> points;
+    size_t size = std::min(count, buffer.size());
+    for (size_t s = 0; s < size; ++s)
+        points.push_back(buffer[(next + buffer.size() - size + s) % buffer.size()]);
+    return points;
+}
+
+size_t Trace::dropped() const
+{
+    return count > buffer.size() ? count - buffer.size() : 0;
+}
+
+bool Trace::writeCsv(std::string filePath) const
+{
+    std::ofstream file(filePath);
+    if (!file.is_open())
+        return false;
+    file << "time,incumbent,bound,nodes,gap\n";
+    std::vector<TracePoint> samples = points();
+    for (const TracePoint &p : samples)
+    {
+        file << p.time << ",";
+        if (!missing(p.incumbent))
+            file << p.incumbent;
+        file << ",";
+        if (!missing(p.bound))
+            file << p.bound;
+        file << "," << p.nodes << "," << primalDualGap(p.incumbent, p.bound) << "\n";
+    }
+    return (bool)file;
+}